@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+
+/**
+ * @brief Bit-packed binary image, storing 64 samples per word.
+ * @details Bits are packed in the same order as Image::samples, so sample indices and coordinates are interchangeable
+ * between the two. Scans skip empty words entirely, making their cost proportional to the number of set samples.
+ */
+class BinaryImage
+{
+public:
+	BinaryImage(const uint32_t width, const uint32_t height);
+	BinaryImage(const Image &image, const uint32_t threshold = 0);
+
+	bool test(const size_t index) const { return (words[index / 64] >> (index % 64)) & 1; }
+	void set(const size_t index) { words[index / 64] |= uint64_t(1) << (index % 64); }
+	void set_range(size_t begin, size_t end);
+
+	size_t count() const;
+	bool any_in_range(size_t begin, size_t end) const;
+	std::vector<Coordinate::Cartesian> find_set_coordinates() const;
+	bool does_block_contain_samples(const int32_t index, const int32_t horz_size, const int32_t vert_size) const;
+
+	Coordinate::Cartesian index_to_coordinate(const int32_t index) const;
+	size_t coordinate_to_index(const Coordinate::Cartesian coord) const;
+
+	const uint32_t width, height;
+	std::vector<uint64_t> words;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+#include <binary-image.h>
+#include <hough.h>
+#include <line-classifier.h>
+
+/**
+ * @brief Canonical tennis court model, mapped to the image by a homography fitted to classified lines.
+ * @details Model coordinates are in metres, with x across the court from the centre line, and y from the base line towards the net.
+ * Only the half of the court containing the classified base and service lines is modelled.
+ */
+class CourtModel
+{
+public:
+	bool fit(const std::vector<ClassifiedLineSegment> &lines);
+	void refine(const BinaryImage &image);
+	bool verify(const BinaryImage &image) const;
+	bool is_fitted() const { return fitted; }
+	bool project(const double x, const double y, double &image_x, double &image_y) const;
+
+private:
+	static constexpr double DOUBLES_HALF_WIDTH = 5.485;
+	static constexpr double SINGLES_HALF_WIDTH = 4.115;
+	static constexpr double SERVICE_LINE_DISTANCE = 5.485; // From the base line.
+	static constexpr double NET_DISTANCE = 11.885;		   // From the base line.
+
+	static constexpr size_t SAMPLES_PER_LINE = 32;
+	static constexpr size_t MIN_SAMPLES_PER_LINE = 8;
+	static constexpr size_t MIN_VERIFIED_LINES = 4;
+	static constexpr double MIN_LINE_SUPPORT = 0.6;
+	static constexpr int32_t SEARCH_RADIUS = 3;
+	static constexpr double CONTROL_OFFSET = 4 * SEARCH_RADIUS; // Distance of control points from a line, in pixels.
+	static constexpr double MAX_CONTROL_SUPPORT = 0.25;		   // Fraction of control points allowed on set samples.
+	static constexpr double MAX_REPROJECTION_ERROR = 10.0;
+	static constexpr double REFINEMENT_INITIAL_STEP = 16.0;
+
+	/**
+	 * @brief Point of the court model, and the image coordinate it was classified at.
+	 */
+	struct Correspondence
+	{
+		double model_x, model_y;
+		double image_x, image_y;
+	};
+
+	struct ModelLine
+	{
+		double x0, y0, x1, y1;
+	};
+
+	static constexpr std::array<ModelLine, 7> model_lines = {{
+		{-DOUBLES_HALF_WIDTH, 0.0, DOUBLES_HALF_WIDTH, 0.0},									 // Base line
+		{-SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE, SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE}, // Service line
+		{0.0, SERVICE_LINE_DISTANCE, 0.0, NET_DISTANCE},										 // Centre service line
+		{-SINGLES_HALF_WIDTH, 0.0, -SINGLES_HALF_WIDTH, NET_DISTANCE},							 // Singles sidelines
+		{SINGLES_HALF_WIDTH, 0.0, SINGLES_HALF_WIDTH, NET_DISTANCE},
+		{-DOUBLES_HALF_WIDTH, 0.0, -DOUBLES_HALF_WIDTH, NET_DISTANCE}, // Doubles sidelines
+		{DOUBLES_HALF_WIDTH, 0.0, DOUBLES_HALF_WIDTH, NET_DISTANCE},
+	}};
+
+	std::array<double, 9> homography = {};
+	bool fitted = false;
+
+	bool fit_homography(const std::vector<Correspondence> &correspondences);
+	double reprojection_error(const Correspondence &correspondence) const;
+	size_t count_line_support(const ModelLine &line, const BinaryImage &image, const int32_t radius, size_t &samples) const;
+	size_t count_control_support(const ModelLine &line, const BinaryImage &image, size_t &samples) const;
+};
+
+/**
+ * @brief Classifies frames of a static camera, only running the full hough and classification pipeline when the court model
+ * fitted to the last classified frame can no longer be verified in the image.
+ */
+class CourtTracker
+{
+public:
+	CourtTracker(const double hough_threshold = 200) : hough_threshold(hough_threshold) {}
+
+	std::vector<ClassifiedLineSegment> classify(const Image &image, const BinaryImage &binary_image);
+
+	size_t verified_frames = 0;
+	size_t classified_frames = 0;
+
+private:
+	const double hough_threshold;
+	Hough hough;
+	LineClassifier classifier;
+	CourtModel model;
+	std::vector<ClassifiedLineSegment> cached_lines;
+};
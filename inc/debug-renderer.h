@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <structs.h>
+#include <image.h>
+
+/**
+ * @brief Renders debug visualisations on a background thread, so debug output can stay enabled without stalling the pipeline.
+ * @details Submitting takes a snapshot of the data to render, and returns without waiting for rendering. If the renderer falls
+ * behind, new snapshots are dropped (usually before being copied) rather than blocking the caller. Rendered images are written as
+ * PNGs to an output directory, or passed to a viewer function. Snapshots which fail to write, or whose viewer throws, are also
+ * counted as dropped.
+ */
+class DebugRenderer
+{
+public:
+	typedef std::function<void(const std::string &, const cv::Mat &)> Viewer;
+
+	DebugRenderer(const std::string_view output_directory, const size_t max_pending = 8);
+	DebugRenderer(Viewer viewer, const size_t max_pending = 8);
+	~DebugRenderer();
+
+	DebugRenderer(const DebugRenderer &) = delete;
+	DebugRenderer &operator=(const DebugRenderer &) = delete;
+
+	void submit_hough_transform(const std::string_view name, const std::vector<std::vector<double>> &hough_transform);
+	void submit_lines(const std::string_view name, const Image &image, const std::vector<ClassifiedLineSegment> &lines,
+					  const bool classified, const std::vector<Coordinate::Cartesian> &intersections = {});
+	void wait_until_idle();
+	size_t dropped() const { return dropped_snapshots; }
+
+	static cv::Mat render_hough_transform(const float *accumulator, const size_t radii, const size_t angle_count);
+	static cv::Mat render_hough_transform(const std::vector<std::vector<double>> &hough_transform);
+	static cv::Mat render_line_segments(const Image &image, const std::vector<ClassifiedLineSegment> &lines);
+
+private:
+	/**
+	 * @brief Data copied from the pipeline at submission, everything needed to render without referring back to it.
+	 */
+	struct Snapshot
+	{
+		std::string name;
+		std::vector<float> accumulator; // Radius-major, for hough transforms.
+		size_t radii = 0, angle_count = 0;
+		std::vector<uint8_t> samples; // For lines, drawn on top of the image.
+		uint32_t width = 0, height = 0;
+		std::vector<ClassifiedLineSegment> lines;
+		std::vector<Coordinate::Cartesian> intersections;
+		bool classified = false;
+	};
+
+	const std::string output_directory;
+	const Viewer viewer;
+	const size_t max_pending;
+
+	std::mutex mutex;
+	std::condition_variable pending_changed;
+	std::deque<Snapshot> pending;
+	bool rendering = false;
+	bool stopping = false;
+	std::atomic<size_t> dropped_snapshots = 0;
+	std::unordered_map<std::string, size_t> name_counts;
+	std::thread worker;
+
+	bool is_full();
+	void enqueue(Snapshot &&snapshot);
+	void run();
+	void render(const Snapshot &snapshot);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+#include <binary-image.h>
+#include <hough.h>
+#include <line-classifier.h>
+
+/**
+ * @brief Classifies frames, skipping the hough and classification pipeline for frames which have not changed since the last
+ * processed frame.
+ * @details A frame is unchanged if the mean absolute difference of a subsampled grid of its samples, against the same grid of the
+ * last processed frame, is within the tolerance. With a tolerance of 0, frames must instead be exact duplicates, compared sample by
+ * sample. Frames are always compared against the last processed frame, so slow drift cannot accumulate unnoticed. A frame
+ * binarised at a different threshold than the last processed frame is always processed.
+ */
+class FrameGate
+{
+public:
+	FrameGate(const double tolerance = 1.0, const uint32_t stride = 8, const double hough_threshold = 200)
+		: tolerance(tolerance), stride(std::max<uint32_t>(stride, 1)), hough_threshold(hough_threshold) {}
+
+	bool is_unchanged(const Image &image, const uint32_t binarize_threshold) const;
+	std::vector<ClassifiedLineSegment> classify(const Image &image, const uint32_t binarize_threshold);
+	double hit_rate() const { return (hits + misses) ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+
+	size_t hits = 0;
+	size_t misses = 0;
+
+private:
+	const double tolerance; // Mean absolute sample difference.
+	const uint32_t stride;	// Rows and columns between compared samples, at least 1.
+	const double hough_threshold;
+	Hough hough;
+	LineClassifier classifier;
+
+	bool has_reference = false;
+	uint32_t reference_width = 0, reference_height = 0;
+	uint32_t reference_threshold = 0;
+	std::vector<uint8_t> reference_samples; // All samples with a tolerance of 0, otherwise the subsampled grid.
+	std::vector<ClassifiedLineSegment> cached_lines;
+
+	std::vector<uint8_t> sample_grid(const Image &image) const;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+#include <image.h>
+
+void benchmark_hough_voting(const Image &image, const uint32_t binarize_threshold);
+void benchmark_hough_batch(const Image &image, const uint32_t binarize_threshold);
@@ -1,9 +1,25 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include <structs.h>
 #include <image.h>
+#include <binary-image.h>
+#include <sparse-accumulator.h>
+
+class DebugRenderer;
+
+/**
+ * @brief Accumulators Hough::find_lines() may vote into.
+ */
+enum class AccumulatorBackend
+{
+	AUTO,	// Sparse if it is expected to use less memory than the dense accumulator.
+	DENSE,	// Array of every cell.
+	SPARSE, // Hash table of voted cells, unless the accumulator exceeds SparseAccumulator::MAX_INDEX.
+};
 
 /**
  * @brief Class to calculate the hough transform and lines of a given image.
@@ -11,10 +27,54 @@
 class Hough
 {
 public:
+	Hough(const Degrees angular_resolution = 1.0) : angular_resolution(angular_resolution) {}
+
+	std::vector<Line> find_lines(const Image &img, const BinaryImage &binary_image, const double threshold = 200, const bool debug = false);
 	std::vector<std::vector<double>> create_hough_transform(const Image &image, const bool debug = false);
+	std::vector<std::vector<double>> create_hough_transform(const BinaryImage &image, const bool debug = false);
+	std::vector<std::vector<std::vector<double>>> create_hough_transforms(const std::vector<BinaryImage> &images, std::vector<std::vector<uint32_t>> *vote_histograms = nullptr) const;
 	std::vector<Line> get_hough_lines(const Image &img, const std::vector<std::vector<double>> &hough_transform, const double threshold = 200, const bool debug = false) const;
+	std::vector<Line> get_hough_lines(const Image &img, const std::vector<std::vector<double>> &hough_transform, const std::vector<uint32_t> &vote_histogram,
+									  const size_t max_candidates = 128, const bool debug = false) const;
+	static double select_threshold(const std::vector<uint32_t> &vote_histogram, const size_t max_candidates);
+	const std::vector<uint32_t> &get_vote_histogram() const { return vote_histogram; }
+	static const std::array<std::pair<double, double>, 270> &trig_table();
+	static std::vector<std::pair<double, double>> trig_table(const Degrees angular_resolution);
+
+	static constexpr size_t AUTO_ANGLE_TILE = 0;
+	static constexpr size_t NAIVE_VOTING = SIZE_MAX; // Votes sample by sample over all angles, as the original transform.
+	void set_angle_tile(const size_t tile) { angle_tile = tile; }
+	static size_t auto_angle_tile(const size_t radii);
+	void set_debug_renderer(DebugRenderer *renderer) { debug_renderer = renderer; }
+	void set_accumulator_backend(const AccumulatorBackend backend) { accumulator_backend = backend; }
+
+	/**
+	 * @brief Angle-major accumulator of the dense transform, with the state of its vote histogram.
+	 * @details Shared with StreamingHough and StratifiedHough, so every dense transform votes through vote_angles().
+	 */
+	struct Accumulator
+	{
+		size_t radii = 0;
+		std::vector<uint32_t> votes; // Angle-major, radii cells per angle.
+		std::vector<uint32_t> histogram;
+		double max_r = 0.0;
+		size_t voted_cells = 0;
+
+		Accumulator() = default;
+		Accumulator(const uint32_t width, const uint32_t height, const size_t angle_count = 270);
+		uint32_t increment(const size_t theta_index, const size_t r) { return votes[theta_index * radii + r]++; }
+		void complete_histogram();
+		std::vector<std::vector<double>> to_hough_transform() const;
+	};
+
+	template <typename VoteAccumulator>
+	static void vote_angles(const std::vector<Coordinate::Cartesian> &coordinates, const std::pair<double, double> *trig, const size_t angle_begin,
+							const size_t angle_end, VoteAccumulator &accumulator);
 
 private:
+	static constexpr Degrees ANGLE_RANGE = 270.0;
+	static constexpr size_t CACHE_BUDGET_BYTES = 128 * 1024; // Accumulator slice voted per tile of angles, about half of a typical L2.
+
 	static constexpr std::array<Degrees, 270> angles = []
 	{
 		std::array<Degrees, 270> angles;
@@ -23,6 +83,48 @@ private:
 		return angles;
 	}();
 
+	/**
+	 * @brief Sparse accumulator, with the state of its vote histogram, for vote_angles().
+	 */
+	struct SparseVotes
+	{
+		SparseAccumulator cells;
+		std::vector<uint32_t> histogram = std::vector<uint32_t>(2, 0);
+		double max_r = 0.0;
+		size_t voted_cells = 0;
+
+		uint32_t increment(const size_t theta_index, const size_t r) { return cells.increment(static_cast<uint32_t>(theta_index), static_cast<uint32_t>(r)); }
+		void complete_histogram(const size_t angle_count) { histogram[0] = count_empty_cells(max_r, angle_count, voted_cells); }
+	};
+
+	static constexpr size_t MAX_BATCH_FRAMES = 8; // Frames sharing an accumulator cell, 32 bytes of votes.
+
+	/**
+	 * @brief Set sample of a batch of frames, with a vote of 1 for each frame it is set in.
+	 */
+	struct BatchSample
+	{
+		Coordinate::Cartesian coordinate;
+		std::array<uint32_t, MAX_BATCH_FRAMES> frames;
+	};
+
+	const Degrees angular_resolution; // Resolutions other than 1 degree are only supported by find_lines().
+	size_t angle_tile = AUTO_ANGLE_TILE;
+	AccumulatorBackend accumulator_backend = AccumulatorBackend::AUTO;
+	DebugRenderer *debug_renderer = nullptr;
+	std::vector<uint32_t> vote_histogram; // Number of accumulator cells per vote count, of the last created transform.
+
+	bool use_sparse_accumulator(const size_t sample_count, const BinaryImage &image) const;
+	std::vector<Line> find_lines_sparse(const std::vector<Coordinate::Cartesian> &coordinates, const size_t max_r, const double threshold);
+	std::vector<Line> find_lines_dense(const std::vector<Coordinate::Cartesian> &coordinates, const uint32_t width, const uint32_t height, const double threshold);
+	std::vector<std::vector<double>> vote(const std::vector<Coordinate::Cartesian> &coordinates, const uint32_t width, const uint32_t height, const bool debug);
+	std::vector<std::vector<double>> vote_naive(const std::vector<Coordinate::Cartesian> &coordinates, const bool debug);
+	void vote_single(const BinaryImage &image, Accumulator &accumulator) const;
+	void vote_batch(const std::vector<BinaryImage> &images, const std::vector<size_t> &batch, std::vector<Accumulator> &accumulators) const;
+	static void vote_angles_batch(const std::vector<BatchSample> &samples, const size_t angle_begin, const size_t angle_end, const size_t radii,
+								  std::vector<uint32_t> &votes);
+	size_t resolve_angle_tile(const size_t radii) const;
+	static uint32_t count_empty_cells(const double max_r, const size_t angle_count, const size_t voted_cells);
 	std::vector<Coordinate::Cartesian> find_valid_sample_indices(const Image &image);
 	double find_max_element(const std::vector<std::vector<double>> &two_dim_vec) const;
 	void prune_lines(std::vector<Line> &lines) const;
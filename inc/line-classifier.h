@@ -5,6 +5,10 @@
 #include <unordered_map>
 #include <utility>
 #include <image.h>
+#include <binary-image.h>
+#include <opencv2/opencv.hpp>
+
+class DebugRenderer;
 
 /**
  * @brief Primative hashing function.
@@ -35,14 +39,21 @@ class LineClassifier
 {
 public:
 	std::vector<ClassifiedLineSegment> classify_lines(const Image& image, std::vector<Line> hough_lines, const bool debug = false);
+	std::vector<ClassifiedLineSegment> classify_lines(const Image& image, const BinaryImage& binary_image, std::vector<Line> hough_lines, const bool debug = false);
+	void set_debug_renderer(DebugRenderer* renderer) { debug_renderer = renderer; }
+
+	void show_classified_lines(const std::vector<ClassifiedLineSegment>& lines, const Image& image, const bool show_markers, const std::vector<Coordinate::Cartesian>& intersections = std::vector<Coordinate::Cartesian>()) const;
+	static cv::Mat draw_classified_lines(const std::vector<ClassifiedLineSegment>& lines, const Image& image, const bool show_markers, const std::vector<Coordinate::Cartesian>& intersections = std::vector<Coordinate::Cartesian>());
 
 private:
+	DebugRenderer* debug_renderer = nullptr;
+
 	static constexpr int8_t NUMBER_OF_HOUGH_INTERSECTIONS_FOR_HORZ_LINES = 5;
 	static constexpr int8_t NUMBER_OF_INTERSECTIONS_FOR_BASE_LINE = 5;
 	static constexpr int8_t NUMBER_OF_INTERSECTIONS_FOR_SERVICE_LINE = 3;
 
 	std::unordered_map<Line, std::vector<Coordinate::Cartesian>, container_hash, container_equal> get_intersections(const std::vector<Line>& lines);
-	void remove_false_horz_line_intersections(std::unordered_map<Line, std::vector<Coordinate::Cartesian>, container_hash, container_equal>& intersections, const Image& image);
+	void remove_false_horz_line_intersections(std::unordered_map<Line, std::vector<Coordinate::Cartesian>, container_hash, container_equal>& intersections, const BinaryImage& image);
 
 	std::vector<ClassifiedLineSegment> classify_horz_lines(std::unordered_map<Line, std::vector<Coordinate::Cartesian>, container_hash, container_equal>& lines);
 	std::vector<ClassifiedLineSegment> classify_vert_lines(const std::unordered_map<Line, std::vector<Coordinate::Cartesian>, container_hash, container_equal>& intersections, const std::vector<ClassifiedLineSegment>& horz_lines);
@@ -53,5 +64,4 @@ private:
 
 	void show_hough_transform(const std::vector<std::vector<double>>& hough_transform) const;
 	void show_hough_lines(const std::vector<Line>& hough_lines, const Image& image) const;
-	void show_classified_lines(const std::vector<ClassifiedLineSegment>& lines, const Image& image, const bool show_markers, const std::vector<Coordinate::Cartesian>& intersections = std::vector<Coordinate::Cartesian>()) const;
 };
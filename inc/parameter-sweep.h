@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+
+/**
+ * @brief Score of one (binarisation threshold, hough threshold) pair against ground truth.
+ */
+struct SweepResult
+{
+	uint32_t binarize_threshold;
+	double hough_threshold;
+	size_t hough_line_count;
+	size_t matched_lines; // Ground truth lines with a classified line of the same class within the match tolerance.
+	size_t false_lines;	  // Classified lines of a ground truth class which matched no ground truth line.
+	double mean_error;	  // Mean endpoint error of matched lines, in pixels.
+};
+
+std::vector<SweepResult> sweep_thresholds(const Image &image, const std::vector<uint32_t> &binarize_thresholds, const std::vector<double> &hough_thresholds,
+										  const std::vector<ClassifiedLineSegment> &ground_truth);
+void print_sweep_results(const std::vector<SweepResult> &results);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include <image.h>
+
+/**
+ * @brief Configuration of a replay, describing the cameras and the pipeline serving them.
+ */
+struct ReplayConfig
+{
+	size_t stream_count = 8;
+	double frames_per_second = 50.0; // Per stream.
+	double duration_seconds = 5.0;
+	size_t worker_count = 0;	// 0 uses one worker per hardware thread.
+	size_t queue_capacity = 4;	// Per stream, frames arriving at a full queue are dropped.
+	uint32_t binarize_threshold = 150;
+	double hough_threshold = 200;
+};
+
+/**
+ * @brief Statistics of a single stream over a replay.
+ */
+struct StreamReport
+{
+	size_t frames_offered = 0;
+	size_t frames_processed = 0;
+	size_t frames_dropped = 0;
+	size_t max_queue_depth = 0;
+	double mean_queue_depth = 0.0; // Sampled as each frame arrives, before it is queued.
+	double latency_p50_ms = 0.0;   // From the frame's scheduled arrival until it is classified.
+	double latency_p95_ms = 0.0;
+	double latency_p99_ms = 0.0;
+	double latency_max_ms = 0.0;
+};
+
+/**
+ * @brief Statistics of a replay.
+ */
+struct ReplayReport
+{
+	std::vector<StreamReport> streams;
+	double elapsed_seconds = 0.0;
+
+	size_t frames_processed() const;
+	size_t frames_dropped() const;
+	double throughput() const { return elapsed_seconds > 0.0 ? frames_processed() / elapsed_seconds : 0.0; }
+	void print() const;
+};
+
+/**
+ * @brief Replays frames into the hough and classification pipeline at camera rates, to check a build keeps up before deployment.
+ * @details Each stream has a pacing thread which offers frames in real time, cycling through the given frames, into a bounded
+ * queue. A pool of workers serves the queues round-robin, running binarisation, the hough transform and classification for each
+ * frame. Frames arriving at a full queue are dropped, as a camera driver would, rather than slowing the stream down.
+ */
+class ReplaySimulator
+{
+public:
+	ReplaySimulator(std::vector<Image> frames, const ReplayConfig &config);
+
+	ReplayReport run();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Frame waiting to be processed.
+	 */
+	struct Job
+	{
+		size_t frame_index;
+		Clock::time_point arrival;
+	};
+
+	const std::vector<Image> frames;
+	const ReplayConfig config;
+
+	std::mutex mutex;
+	std::condition_variable jobs_changed;
+	std::vector<std::deque<Job>> queues;
+	std::vector<StreamReport> reports;
+	std::vector<std::vector<double>> latencies; // Per stream, in milliseconds.
+	std::vector<size_t> queue_depth_totals;
+	size_t next_queue = 0;
+	size_t pacers_running = 0;
+
+	void pace_stream(const size_t stream, const Clock::time_point start);
+	void serve();
+};
+
+std::vector<Image> make_synthetic_variants(const Image &image, const size_t count);
+bool load_raw_frames(const std::vector<std::string_view> &paths, const uint32_t width, const uint32_t height, std::vector<Image> &frames);
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <structs.h>
+
+/**
+ * @brief Interface for consumers of per-frame classification results.
+ * @note Sinks are not thread safe, a sink is expected to be owned by a single pipeline thread.
+ */
+class ResultSink
+{
+public:
+	virtual ~ResultSink() = default;
+
+	virtual void write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines) = 0;
+	virtual void flush() {}
+};
+
+/**
+ * @brief Writes results as CSV rows, in the same format as results.csv.
+ * @details Rows are formatted into an in-memory buffer, which is only written to disk once full, on flush, or on destruction.
+ */
+class CsvResultSink : public ResultSink
+{
+public:
+	CsvResultSink(const std::string_view path, const bool include_frame_id = false, const bool append = false);
+	~CsvResultSink() override;
+
+	void write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines) override;
+	void flush() override;
+
+private:
+	static constexpr size_t BUFFER_CAPACITY = 1 << 20;
+
+	FILE *file = nullptr;
+	std::string buffer;
+	const bool include_frame_id;
+
+	void append_number(const int64_t value);
+};
+
+/**
+ * @brief Forwards results to a user supplied function, e.g. for overlays or network publication.
+ */
+class CallbackResultSink : public ResultSink
+{
+public:
+	typedef std::function<void(const uint64_t, const int64_t, const std::vector<ClassifiedLineSegment> &)> Callback;
+
+	CallbackResultSink(Callback callback) : callback(std::move(callback)) {}
+
+	void write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines) override
+	{
+		callback(frame_id, timestamp, lines);
+	}
+
+private:
+	Callback callback;
+};
+
+/**
+ * @brief Header at the start of every binary result log.
+ */
+struct BinaryLogHeader
+{
+	static constexpr char MAGIC[8] = {'L', 'C', 'L', 'O', 'G', 0, 0, 0};
+	static constexpr uint32_t VERSION = 1;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t record_count;
+	uint64_t reserved;
+};
+
+/**
+ * @brief Fixed size record of a binary result log, one per classified line.
+ */
+struct BinaryLogRecord
+{
+	uint64_t frame_id;
+	int64_t timestamp;
+	int32_t line_class;
+	int32_t origin_x, origin_y;
+	int32_t destination_x, destination_y;
+	int32_t reserved;
+};
+
+static_assert(sizeof(BinaryLogHeader) == 32, "Binary log header layout must not change");
+static_assert(sizeof(BinaryLogRecord) == 40, "Binary log record layout must not change");
+
+/**
+ * @brief Appends results to a binary log of fixed size records, written through a memory-mapped file.
+ * @details The file is grown geometrically and remapped as required, so appending a record is a copy into mapped memory.
+ * The record count in the header is updated on flush, and the file is truncated to its used length on destruction. If the log
+ * cannot be created or grown, the failure is reported on standard error and is_valid() returns false; records written before a
+ * failed growth are kept.
+ */
+class BinaryLogResultSink : public ResultSink
+{
+public:
+	BinaryLogResultSink(const std::string_view path);
+	~BinaryLogResultSink() override;
+
+	BinaryLogResultSink(const BinaryLogResultSink &) = delete;
+	BinaryLogResultSink &operator=(const BinaryLogResultSink &) = delete;
+
+	void write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines) override;
+	void flush() override;
+	bool is_valid() const { return !failed; }
+
+private:
+	static constexpr size_t INITIAL_FILE_SIZE = 1 << 20;
+
+	std::string path;
+	intptr_t file_handle = -1;
+	intptr_t mapping_handle = 0;
+	uint8_t *mapped = nullptr;
+	size_t mapped_size = 0;
+	uint64_t record_count = 0;
+	bool failed = false; // Set once the log could not be created or grown, after which records are dropped.
+
+	void report_failure(const std::string &reason);
+	void map(const size_t size);
+	void unmap();
+	BinaryLogHeader &header() { return *reinterpret_cast<BinaryLogHeader *>(mapped); }
+};
+
+/**
+ * @brief Sequential reader of binary result logs.
+ */
+class BinaryLogReader
+{
+public:
+	BinaryLogReader(const std::string_view path);
+	~BinaryLogReader();
+
+	BinaryLogReader(const BinaryLogReader &) = delete;
+	BinaryLogReader &operator=(const BinaryLogReader &) = delete;
+
+	bool is_valid() const { return valid; }
+	uint64_t size() const { return header.record_count; }
+	bool next(BinaryLogRecord &record);
+
+private:
+	FILE *file = nullptr;
+	BinaryLogHeader header = {};
+	uint64_t records_read = 0;
+	bool valid = false;
+};
+
+int print_binary_log(const std::string_view path);
+std::vector<ClassifiedLineSegment> read_csv_results(const std::string_view path);
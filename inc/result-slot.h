@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <structs.h>
+#include <result-sink.h>
+
+/**
+ * @brief Latest classification of a single stream, published by the pipeline and read by any number of consumers without locks.
+ * @details The slot is triple buffered, each buffer guarded by a sequence lock. The single writer fills the buffer after the one
+ * last published, so it never waits for readers, and readers copy the last published buffer, retrying only if the writer laps
+ * them and starts overwriting it. The payload is held in relaxed atomics, so a torn copy is detected rather than being a data race.
+ * @note Only one thread may publish to a slot.
+ */
+class LatestResultSlot
+{
+public:
+	static constexpr size_t MAX_LINES = 32;
+
+	/**
+	 * @brief Consistent copy of a published classification.
+	 */
+	struct Snapshot
+	{
+		uint64_t sequence = 0; // Incremented on each publication, starting at 1.
+		uint64_t frame_id = 0;
+		int64_t timestamp = 0;
+		std::vector<ClassifiedLineSegment> lines;
+	};
+
+	bool publish(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines);
+	bool read(Snapshot &snapshot) const;
+	uint64_t sequence() const { return published.load(std::memory_order_acquire); }
+
+private:
+	static constexpr size_t VALUES_PER_LINE = 5;
+	static constexpr size_t BUFFER_COUNT = 3;
+
+	struct alignas(64) Buffer
+	{
+		std::atomic<uint64_t> version = 0; // Odd whilst being written, 2 * sequence once published.
+		std::atomic<uint64_t> frame_id = 0;
+		std::atomic<int64_t> timestamp = 0;
+		std::atomic<uint32_t> line_count = 0;
+		std::atomic<int64_t> values[MAX_LINES * VALUES_PER_LINE] = {};
+	};
+
+	Buffer buffers[BUFFER_COUNT];
+	alignas(64) std::atomic<uint64_t> published = 0;
+};
+
+/**
+ * @brief Publishes each frame's results to a stream's latest result slot.
+ */
+class ResultSlotSink : public ResultSink
+{
+public:
+	ResultSlotSink(LatestResultSlot &slot) : slot(slot) {}
+
+	void write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines) override
+	{
+		slot.publish(frame_id, timestamp, lines);
+	}
+
+private:
+	LatestResultSlot &slot;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+#include <binary-image.h>
+
+/**
+ * @brief Header at the start of every run-length encoded frame.
+ * @details The header is followed by (count, value) byte pairs, each a run of 1 to 255 samples of the same value. Runs continue
+ * across rows, in the order of Image::samples.
+ */
+struct RleFrameHeader
+{
+	static constexpr char MAGIC[8] = {'L', 'C', 'R', 'L', 'E', 0, 0, 0};
+	static constexpr uint32_t VERSION = 1;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t width, height;
+	uint32_t floor; // Samples at or below the floor were encoded as 0, so lower thresholds cannot be decoded.
+	uint64_t payload_size;
+};
+
+static_assert(sizeof(RleFrameHeader) == 32, "RLE frame header layout must not change");
+
+std::vector<uint8_t> rle_encode(const Image &image, const uint8_t floor = 0);
+bool write_rle_frame(const std::string_view path, const Image &image, const uint8_t floor = 0);
+
+bool rle_decode_binary(const uint8_t *runs, const size_t size, const uint32_t floor, BinaryImage &binary_image, const uint32_t threshold);
+bool rle_decode_coordinates(const uint8_t *runs, const size_t size, const uint32_t floor, const uint32_t width, const uint32_t height,
+							const uint32_t threshold, std::vector<Coordinate::Cartesian> &coordinates);
+bool read_rle_frame(const std::string_view path, std::vector<uint8_t> &runs, uint32_t &width, uint32_t &height, uint32_t &floor);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <image.h>
+
+int run_self_checks(const Image &image, const uint32_t binarize_threshold, const std::string_view name = {});
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Sparse hough accumulator, storing only cells which receive votes in an open-addressing hash table.
+ * @details Memory is proportional to the number of voted cells, rather than to the image diagonal and angular resolution.
+ * Cells are addressed by an angle index and a radius bin of up to 16 bits each, packed with the cell's votes into an 8 byte slot.
+ * The table uses linear probing with power-of-two capacity, doubling once three quarters full.
+ */
+class SparseAccumulator
+{
+public:
+	/**
+	 * @brief Voted cell of the accumulator.
+	 */
+	struct Cell
+	{
+		uint32_t theta_index;
+		uint32_t r;
+		uint32_t votes;
+	};
+
+	static constexpr uint32_t MAX_INDEX = 0xFFFE; // Largest angle index and radius bin.
+
+	SparseAccumulator(const size_t expected_cells = 1024);
+
+	uint32_t increment(const uint32_t theta_index, const uint32_t r);
+	uint32_t get(const uint32_t theta_index, const uint32_t r) const;
+	std::vector<Cell> cells_above(const uint32_t threshold) const;
+	size_t size() const { return count; }
+	size_t memory_usage() const { return slots.size() * sizeof(Slot); }
+	static size_t memory_usage(const size_t expected_cells);
+
+private:
+	static constexpr uint32_t EMPTY_KEY = ~uint32_t(0);
+
+	struct Slot
+	{
+		uint32_t key = EMPTY_KEY;
+		uint32_t votes = 0;
+	};
+
+	std::vector<Slot> slots;
+	size_t count = 0;
+
+	static uint32_t make_key(const uint32_t theta_index, const uint32_t r) { return (theta_index << 16) | r; }
+	static size_t capacity_for(const size_t cells) { return std::bit_ceil(std::max<size_t>(cells + cells / 3 + 1, 16)); }
+	size_t find_slot(const uint32_t key) const;
+	void grow();
+};
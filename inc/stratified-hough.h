@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <structs.h>
+#include <image.h>
+#include <hough.h>
+
+/**
+ * @brief Hough accumulator stratified by sample intensity, giving the transform of any candidate binarisation threshold without
+ * re-voting.
+ * @details Each sample above the lowest candidate threshold is voted once, into the bucket between the candidate thresholds it
+ * falls in. Suffix sums over the buckets then turn bucket k into the accumulator of all samples above threshold k, which is
+ * identical to binarising at that threshold and calling Hough::create_hough_transform().
+ */
+class StratifiedHough
+{
+public:
+	StratifiedHough(const Image &image, std::vector<uint32_t> thresholds);
+
+	std::vector<std::vector<double>> create_hough_transform(const size_t threshold_index) const;
+	const std::vector<uint32_t> &get_thresholds() const { return thresholds; }
+	size_t memory_usage() const;
+
+private:
+	std::vector<uint32_t> thresholds; // Ascending binarisation thresholds, one bucket each.
+	std::vector<Hough::Accumulator> accumulators; // One per bucket, of the samples above its threshold once voting is complete.
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <structs.h>
+#include <binary-image.h>
+#include <hough.h>
+
+/**
+ * @brief Hough transform of a frame which arrives in row stripes, e.g. from a sensor line buffer or a partial file read.
+ * @details Each stripe is binarised and voted as soon as it is pushed, so only the accumulator and the bit-packed binary image are
+ * kept, never the full 8-bit frame. Once the last stripe is pushed, the transform is identical to binarising the whole frame and
+ * calling Hough::create_hough_transform().
+ */
+class StreamingHough
+{
+public:
+	StreamingHough(const uint32_t width, const uint32_t height, const uint32_t binarize_threshold);
+
+	void push_rows(const uint8_t *samples, const uint32_t row_count);
+	bool is_complete() const { return rows_received == height; }
+	std::vector<std::vector<double>> finish() const;
+
+	const BinaryImage &get_binary_image() const { return binary_image; }
+	const std::vector<uint32_t> &get_vote_histogram() const { return accumulator.histogram; }
+
+	const uint32_t width, height;
+
+private:
+	const uint32_t binarize_threshold;
+	uint32_t rows_received = 0;
+
+	BinaryImage binary_image;
+	Hough::Accumulator accumulator;
+	std::vector<Coordinate::Cartesian> stripe_coordinates;
+};
+
+bool stream_raw_file(const std::string_view path, StreamingHough &hough, const uint32_t stripe_rows = 64);
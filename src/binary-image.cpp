@@ -0,0 +1,166 @@
+#include <binary-image.h>
+#include <algorithm>
+#include <bit>
+
+/**
+ * @brief Constructs an empty binary image.
+ * @param[in] width - Width of image.
+ * @param[in] height - Height of image.
+ */
+BinaryImage::BinaryImage(const uint32_t width, const uint32_t height)
+	: width(width), height(height), words((static_cast<size_t>(width) * height + 63) / 64, 0)
+{
+}
+
+/**
+ * @brief Constructs binary image from an image, setting samples greater than the threshold.
+ * @note Default threshold of 0 packs an image which has already been binarised.
+ * @param[in] image - Image to pack.
+ * @param[in] threshold - Optional argument, samples greater than which are set.
+ */
+BinaryImage::BinaryImage(const Image &image, const uint32_t threshold) : BinaryImage(image.width, image.height)
+{
+	const size_t full_words = image.samples.size() / 64;
+	for (size_t w = 0; w < full_words; w++)
+	{
+		const uint8_t *samples = image.samples.data() + w * 64;
+		uint64_t word = 0;
+		for (size_t b = 0; b < 64; b++)
+			word |= static_cast<uint64_t>(samples[b] > threshold) << b;
+		words[w] = word;
+	}
+
+	for (size_t i = full_words * 64; i < image.samples.size(); i++)
+		if (image.samples[i] > threshold)
+			set(i);
+}
+
+/**
+ * @brief Counts all set samples.
+ * @return Number of set samples.
+ */
+size_t BinaryImage::count() const
+{
+	size_t total = 0;
+	for (const uint64_t word : words)
+		total += std::popcount(word);
+	return total;
+}
+
+/**
+ * @brief Determines if any sample is set within a range of sample indices.
+ * @param[in] begin - First index of the range.
+ * @param[in] end - One past the last index of the range.
+ * @return Flag indicating if any sample in the range is set.
+ */
+bool BinaryImage::any_in_range(size_t begin, size_t end) const
+{
+	end = std::min(end, static_cast<size_t>(width) * height);
+	if (begin >= end)
+		return false;
+
+	const size_t first_word = begin / 64, last_word = (end - 1) / 64;
+	const uint64_t first_mask = ~uint64_t(0) << (begin % 64);
+	const uint64_t last_mask = ~uint64_t(0) >> (63 - (end - 1) % 64);
+
+	if (first_word == last_word)
+		return std::popcount(words[first_word] & first_mask & last_mask) != 0;
+
+	if (std::popcount(words[first_word] & first_mask) != 0 || std::popcount(words[last_word] & last_mask) != 0)
+		return true;
+	for (size_t w = first_word + 1; w < last_word; w++)
+		if (words[w] != 0)
+			return true;
+	return false;
+}
+
+/**
+ * @brief Sets all samples in a range of indices, a word at a time.
+ * @param[in] begin - First index of the range.
+ * @param[in] end - One past the last index of the range, clamped to the image.
+ */
+void BinaryImage::set_range(size_t begin, size_t end)
+{
+	end = std::min(end, static_cast<size_t>(width) * height);
+	if (begin >= end)
+		return;
+
+	const size_t first_word = begin / 64, last_word = (end - 1) / 64;
+	const uint64_t first_mask = ~uint64_t(0) << (begin % 64);
+	const uint64_t last_mask = ~uint64_t(0) >> (63 - (end - 1) % 64);
+
+	if (first_word == last_word)
+	{
+		words[first_word] |= first_mask & last_mask;
+		return;
+	}
+
+	words[first_word] |= first_mask;
+	for (size_t w = first_word + 1; w < last_word; w++)
+		words[w] = ~uint64_t(0);
+	words[last_word] |= last_mask;
+}
+
+/**
+ * @brief Finds coordinates of all set samples, scanning each word with count-trailing-zeros.
+ * @return Cartesian coordinates of set samples, in the same order as Hough::find_valid_sample_indices().
+ */
+std::vector<Coordinate::Cartesian> BinaryImage::find_set_coordinates() const
+{
+	std::vector<Coordinate::Cartesian> coordinates;
+	coordinates.reserve(count());
+
+	for (size_t w = 0; w < words.size(); w++)
+	{
+		for (uint64_t word = words[w]; word != 0; word &= word - 1)
+		{
+			const size_t index = w * 64 + std::countr_zero(word);
+			coordinates.push_back(index_to_coordinate(static_cast<int32_t>(index)));
+		}
+	}
+	return coordinates;
+}
+
+/**
+ * @brief Scans ROI of image to determine if any set samples exist, using popcount per row of the ROI.
+ * @note Matches Image::does_block_contain_samples(), including rows of the ROI that wrap across the image edge.
+ * @param[in] index - Sample index which acts as the ROI centre point.
+ * @param[in] horz_size - Horizontal size of the ROI.
+ * @param[in] vert_size - Vertical size of the ROI.
+ * @return Boolean flag indicating if ROI contains set samples.
+ */
+bool BinaryImage::does_block_contain_samples(const int32_t index, const int32_t horz_size, const int32_t vert_size) const
+{
+	Coordinate::Cartesian coords = index_to_coordinate(index);
+	coords.x -= horz_size / 2;
+	coords.y -= vert_size / 2; //centers search around index.
+
+	for (int64_t r = coords.y; r < coords.y + vert_size; r++)
+	{
+		const int64_t begin = r * width + coords.x;
+		const int64_t end = begin + horz_size;
+		if (end > 0 && any_in_range(static_cast<size_t>(std::max<int64_t>(begin, 0)), static_cast<size_t>(end)))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Converts 1D index to Cartesian coordinate.
+ * @param[in] index- 1D index to convert.
+ * @return Cartesian coordinate of index.
+ */
+Coordinate::Cartesian BinaryImage::index_to_coordinate(const int32_t index) const
+{
+	return Coordinate::Cartesian(index / width, index % width);
+}
+
+/**
+ * @brief Converts cartesian coordinate to 1D index.
+ * @param[in] coord - Cartesian coordinate to convert.
+ * @return 1D index of the associated cartesian coordinate of the image.
+ */
+size_t BinaryImage::coordinate_to_index(const Coordinate::Cartesian coord) const
+{
+	return this->width * coord.x + coord.y;
+}
@@ -0,0 +1,437 @@
+#include <court-model.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	/**
+	 * @brief Solves a dense linear system in place, using Gaussian elimination with partial pivoting.
+	 * @param[in,out] a - Row-major square matrix, destroyed by the solve.
+	 * @param[in,out] b - Right hand side, replaced by the solution.
+	 * @return Flag indicating if the system was solvable (false if singular).
+	 */
+	template <size_t N>
+	bool solve_linear_system(std::array<std::array<double, N>, N> &a, std::array<double, N> &b)
+	{
+		for (size_t col = 0; col < N; col++)
+		{
+			size_t pivot = col;
+			for (size_t row = col + 1; row < N; row++)
+				if (std::abs(a[row][col]) > std::abs(a[pivot][col]))
+					pivot = row;
+			if (std::abs(a[pivot][col]) < 1e-12)
+				return false;
+			std::swap(a[col], a[pivot]);
+			std::swap(b[col], b[pivot]);
+
+			for (size_t row = col + 1; row < N; row++)
+			{
+				const double factor = a[row][col] / a[col][col];
+				for (size_t k = col; k < N; k++)
+					a[row][k] -= factor * a[col][k];
+				b[row] -= factor * b[col];
+			}
+		}
+
+		for (size_t col = N; col-- > 0;)
+		{
+			for (size_t k = col + 1; k < N; k++)
+				b[col] -= a[col][k] * b[k];
+			b[col] /= a[col][col];
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Similarity transform which moves points to their centroid, at an average distance of sqrt(2), to condition the fit.
+	 * @param[in] points - Points to normalise, as x-y pairs.
+	 * @return Row-major 3x3 normalising transform.
+	 */
+	std::array<double, 9> normalising_transform(const std::vector<std::pair<double, double>> &points)
+	{
+		double cx = 0.0, cy = 0.0;
+		for (const auto &[x, y] : points)
+		{
+			cx += x;
+			cy += y;
+		}
+		cx /= points.size();
+		cy /= points.size();
+
+		double mean_distance = 0.0;
+		for (const auto &[x, y] : points)
+			mean_distance += std::hypot(x - cx, y - cy);
+		mean_distance /= points.size();
+
+		const double s = (mean_distance > 0.0) ? std::numbers::sqrt2 / mean_distance : 1.0;
+		return {s, 0.0, -s * cx, 0.0, s, -s * cy, 0.0, 0.0, 1.0};
+	}
+
+	std::array<double, 9> multiply(const std::array<double, 9> &a, const std::array<double, 9> &b)
+	{
+		std::array<double, 9> c = {};
+		for (size_t r = 0; r < 3; r++)
+			for (size_t col = 0; col < 3; col++)
+				for (size_t k = 0; k < 3; k++)
+					c[r * 3 + col] += a[r * 3 + k] * b[k * 3 + col];
+		return c;
+	}
+
+	/**
+	 * @brief Orders the endpoints of a horizontal court line from left to right in the image, i.e. by image column.
+	 * @note Classified line segments are in drawing coordinates, x being the image column and y the row (as passed to cv::Point),
+	 * unlike the x = row convention of Image::index_to_coordinate().
+	 * @param[in] line - Classified horizontal line.
+	 * @return Left and right endpoints of the line.
+	 */
+	std::pair<Coordinate::Cartesian, Coordinate::Cartesian> left_to_right(const ClassifiedLineSegment &line)
+	{
+		const int64_t origin_column = line.origin.x, destination_column = line.destination.x;
+		if (origin_column <= destination_column)
+			return {line.origin, line.destination};
+		return {line.destination, line.origin};
+	}
+}
+
+/**
+ * @brief Fits the homography from the court model to the image, using the corners and intersections of classified lines.
+ * @details The doubles and singles corners of the base line, the singles corners of the service line, and the origin of the
+ * centre service line provide up to 7 correspondences.
+ * @param[in] lines - Classified lines of a frame, as returned by LineClassifier::classify_lines().
+ * @return Flag indicating if the model was fitted. On failure, the model is left unfitted.
+ */
+bool CourtModel::fit(const std::vector<ClassifiedLineSegment> &lines)
+{
+	fitted = false;
+
+	std::vector<Correspondence> correspondences;
+	for (const ClassifiedLineSegment &line : lines)
+	{
+		// Horizontal lines are ordered by their intersections, so their endpoints are sorted into left and right.
+		const auto [left, right] = left_to_right(line);
+		const double lx = static_cast<double>(left.x), ly = static_cast<double>(left.y);
+		const double rx = static_cast<double>(right.x), ry = static_cast<double>(right.y);
+
+		switch (line.line_class)
+		{
+		case LineClasses::BASE_LINE:
+			correspondences.push_back({-DOUBLES_HALF_WIDTH, 0.0, lx, ly});
+			correspondences.push_back({DOUBLES_HALF_WIDTH, 0.0, rx, ry});
+			break;
+		case LineClasses::INNER_BASE_LINE:
+			correspondences.push_back({-SINGLES_HALF_WIDTH, 0.0, lx, ly});
+			correspondences.push_back({SINGLES_HALF_WIDTH, 0.0, rx, ry});
+			break;
+		case LineClasses::SERVICE_LINE:
+			correspondences.push_back({-SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE, lx, ly});
+			correspondences.push_back({SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE, rx, ry});
+			break;
+		case LineClasses::CENTRE_SERVICE_LINE:
+			correspondences.push_back({0.0, SERVICE_LINE_DISTANCE, static_cast<double>(line.origin.x), static_cast<double>(line.origin.y)});
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Classified corners outside of the image are unreliable (e.g. a doubles corner beyond the image edge), so the fit is made
+	// to the largest set of correspondences consistent with any minimal 4 point fit.
+	std::vector<Correspondence> best_inliers;
+	const size_t n = correspondences.size();
+	for (size_t a = 0; a < n; a++)
+		for (size_t b = a + 1; b < n; b++)
+			for (size_t c = b + 1; c < n; c++)
+				for (size_t d = c + 1; d < n; d++)
+				{
+					if (!fit_homography({correspondences[a], correspondences[b], correspondences[c], correspondences[d]}))
+						continue;
+
+					std::vector<Correspondence> inliers;
+					for (const Correspondence &correspondence : correspondences)
+						if (reprojection_error(correspondence) <= MAX_REPROJECTION_ERROR)
+							inliers.push_back(correspondence);
+					if (inliers.size() > best_inliers.size())
+						best_inliers = inliers;
+				}
+
+	fitted = fit_homography(best_inliers);
+	return fitted;
+}
+
+/**
+ * @brief Calculates the distance between a correspondence's image coordinate, and its model point projected by the homography.
+ * @param[in] correspondence - Correspondence to check.
+ * @return Reprojection error, in pixels.
+ */
+double CourtModel::reprojection_error(const Correspondence &correspondence) const
+{
+	double x, y;
+	if (!project(correspondence.model_x, correspondence.model_y, x, y))
+		return std::numeric_limits<double>::infinity();
+	return std::hypot(x - correspondence.image_x, y - correspondence.image_y);
+}
+
+/**
+ * @brief Fits the homography to a set of correspondences by least squares (DLT, with the last element fixed to 1).
+ * @param[in] correspondences - Model points and their image coordinates.
+ * @return Flag indicating if the fit was possible, which requires at least 2 points on both the base and service lines.
+ */
+bool CourtModel::fit_homography(const std::vector<Correspondence> &correspondences)
+{
+	// At least 2 points on each of the 2 horizontal lines, otherwise the points are collinear.
+	size_t base_line_points = 0, service_line_points = 0;
+	for (const Correspondence &c : correspondences)
+		(c.model_y == 0.0 ? base_line_points : service_line_points)++;
+	if (base_line_points < 2 || service_line_points < 2)
+		return false;
+
+	std::vector<std::pair<double, double>> model_points, image_points;
+	for (const Correspondence &c : correspondences)
+	{
+		model_points.push_back({c.model_x, c.model_y});
+		image_points.push_back({c.image_x, c.image_y});
+	}
+	const std::array<double, 9> model_norm = normalising_transform(model_points);
+	const std::array<double, 9> image_norm = normalising_transform(image_points);
+
+	std::array<std::array<double, 8>, 8> ata = {};
+	std::array<double, 8> atb = {};
+	for (const Correspondence &c : correspondences)
+	{
+		const double x = model_norm[0] * c.model_x + model_norm[2], y = model_norm[4] * c.model_y + model_norm[5];
+		const double u = image_norm[0] * c.image_x + image_norm[2], v = image_norm[4] * c.image_y + image_norm[5];
+
+		const std::array<std::array<double, 8>, 2> rows = {{
+			{x, y, 1.0, 0.0, 0.0, 0.0, -u * x, -u * y},
+			{0.0, 0.0, 0.0, x, y, 1.0, -v * x, -v * y},
+		}};
+		const std::array<double, 2> rhs = {u, v};
+		for (size_t r = 0; r < rows.size(); r++)
+			for (size_t i = 0; i < 8; i++)
+			{
+				for (size_t j = 0; j < 8; j++)
+					ata[i][j] += rows[r][i] * rows[r][j];
+				atb[i] += rows[r][i] * rhs[r];
+			}
+	}
+
+	if (!solve_linear_system(ata, atb))
+		return false;
+
+	// Undo normalisation, H = image_norm^-1 * H_normalised * model_norm
+	const std::array<double, 9> normalised = {atb[0], atb[1], atb[2], atb[3], atb[4], atb[5], atb[6], atb[7], 1.0};
+	const double s = image_norm[0];
+	const std::array<double, 9> image_denorm = {1.0 / s, 0.0, -image_norm[2] / s, 0.0, 1.0 / s, -image_norm[5] / s, 0.0, 0.0, 1.0};
+	homography = multiply(image_denorm, multiply(normalised, model_norm));
+	return true;
+}
+
+/**
+ * @brief Projects a court model point into the image.
+ * @param[in] x - Model x coordinate, in metres.
+ * @param[in] y - Model y coordinate, in metres.
+ * @param[out] image_x - Image x coordinate (column).
+ * @param[out] image_y - Image y coordinate (row).
+ * @return Flag indicating if the point projects in front of the camera.
+ */
+bool CourtModel::project(const double x, const double y, double &image_x, double &image_y) const
+{
+	const double w = homography[6] * x + homography[7] * y + homography[8];
+	if (w <= 1e-9)
+		return false;
+	image_x = (homography[0] * x + homography[1] * y + homography[2]) / w;
+	image_y = (homography[3] * x + homography[4] * y + homography[5]) / w;
+	return true;
+}
+
+/**
+ * @brief Verifies the fitted model against a binary image, by sampling points along each projected court line.
+ * @details Costs SAMPLES_PER_LINE small ROI lookups per line, rather than a hough transform of the whole image. Line samples are
+ * also found in frames which are mostly set (e.g. overexposed), so control points beside each line must mostly be unset.
+ * @param[in] image - Binary image of the frame.
+ * @return Flag indicating if every visible court line is still present in the image.
+ */
+bool CourtModel::verify(const BinaryImage &image) const
+{
+	if (!fitted)
+		return false;
+
+	size_t visible_lines = 0, control_hits = 0, control_samples = 0;
+	for (const ModelLine &line : model_lines)
+	{
+		size_t samples = 0;
+		const size_t hits = count_line_support(line, image, SEARCH_RADIUS, samples);
+		if (samples < MIN_SAMPLES_PER_LINE)
+			continue; // Not enough of the line is in the image to be checked.
+		if (hits < MIN_LINE_SUPPORT * samples)
+			return false;
+		visible_lines++;
+		control_hits += count_control_support(line, image, control_samples);
+	}
+	return visible_lines >= MIN_VERIFIED_LINES && control_hits <= MAX_CONTROL_SUPPORT * control_samples;
+}
+
+/**
+ * @brief Refines the fitted model against the binary image it was fitted from.
+ * @details Classified corners are only accurate to within several pixels, as hough lines are averaged during pruning. The model is
+ * parameterised by the image positions of the 4 singles corners, which are moved in decreasing steps whilst doing so increases the
+ * number of projected line samples lying on set samples.
+ * @param[in] image - Binary image of the frame the model was fitted to.
+ */
+void CourtModel::refine(const BinaryImage &image)
+{
+	if (!fitted)
+		return;
+
+	std::array<Correspondence, 4> corners = {{
+		{-SINGLES_HALF_WIDTH, 0.0},
+		{SINGLES_HALF_WIDTH, 0.0},
+		{-SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE},
+		{SINGLES_HALF_WIDTH, SERVICE_LINE_DISTANCE},
+	}};
+	for (Correspondence &corner : corners)
+		if (!project(corner.model_x, corner.model_y, corner.image_x, corner.image_y))
+			return;
+
+	// The search radius shrinks with the step, so coarse steps are guided by lines which are still several pixels away.
+	const auto score = [&](const int32_t radius)
+	{
+		size_t hits = 0, samples = 0;
+		for (const ModelLine &line : model_lines)
+			hits += count_line_support(line, image, radius, samples);
+		return hits;
+	};
+
+	const std::array<double, 9> fitted_homography = homography;
+	for (double step = REFINEMENT_INITIAL_STEP; step >= 1.0; step /= 2.0)
+	{
+		// The homography is left at the last candidate, which may have been rejected, so it is refitted to the accepted corners.
+		if (!fit_homography({corners.begin(), corners.end()}))
+			break;
+		const int32_t radius = static_cast<int32_t>(step);
+		size_t best_score = score(radius);
+		for (bool improved = true; improved;)
+		{
+			improved = false;
+			for (Correspondence &corner : corners)
+				for (double *coordinate : {&corner.image_x, &corner.image_y})
+					for (const double direction : {-1.0, 1.0})
+					{
+						*coordinate += direction * step;
+						const size_t candidate_score = fit_homography({corners.begin(), corners.end()}) ? score(radius) : 0;
+						if (candidate_score > best_score)
+						{
+							best_score = candidate_score;
+							improved = true;
+						}
+						else
+						{
+							*coordinate -= direction * step;
+						}
+					}
+		}
+	}
+
+	if (!fit_homography({corners.begin(), corners.end()}))
+		homography = fitted_homography;
+}
+
+/**
+ * @brief Counts samples along a projected model line which lie on, or near, set samples of the image.
+ * @param[in] line - Model line to check.
+ * @param[in] image - Binary image of the frame.
+ * @param[in] radius - Radius of the square ROI searched around each sample.
+ * @param[in,out] samples - Incremented by the number of line samples which project into the image.
+ * @return Number of line samples with a set sample in their ROI.
+ */
+size_t CourtModel::count_line_support(const ModelLine &line, const BinaryImage &image, const int32_t radius, size_t &samples) const
+{
+	size_t hits = 0;
+	for (size_t i = 0; i < SAMPLES_PER_LINE; i++)
+	{
+		const double t = (i + 0.5) / SAMPLES_PER_LINE;
+		double x, y;
+		if (!project(line.x0 + t * (line.x1 - line.x0), line.y0 + t * (line.y1 - line.y0), x, y))
+			continue;
+
+		const int64_t col = std::lround(x), row = std::lround(y);
+		if (col < 0 || row < 0 || col >= image.width || row >= image.height)
+			continue;
+		samples++;
+
+		const int64_t first_col = std::max<int64_t>(col - radius, 0);
+		const int64_t last_col = std::min<int64_t>(col + radius, image.width - 1);
+		for (int64_t r = std::max<int64_t>(row - radius, 0); r <= std::min<int64_t>(row + radius, image.height - 1); r++)
+		{
+			if (image.any_in_range(r * image.width + first_col, r * image.width + last_col + 1))
+			{
+				hits++;
+				break;
+			}
+		}
+	}
+	return hits;
+}
+
+/**
+ * @brief Counts control points beside a projected model line which lie on set samples of the image.
+ * @details Each line sample has a control point on both sides, CONTROL_OFFSET pixels away perpendicular to the projected line, so
+ * beyond the search radius of count_line_support().
+ * @param[in] line - Model line to check.
+ * @param[in] image - Binary image of the frame.
+ * @param[in,out] samples - Incremented by the number of control points which lie in the image.
+ * @return Number of control points on set samples.
+ */
+size_t CourtModel::count_control_support(const ModelLine &line, const BinaryImage &image, size_t &samples) const
+{
+	size_t hits = 0;
+	for (size_t i = 0; i < SAMPLES_PER_LINE; i++)
+	{
+		const double t = (i + 0.5) / SAMPLES_PER_LINE, next_t = (i + 1.5) / SAMPLES_PER_LINE;
+		double x, y, next_x, next_y;
+		if (!project(line.x0 + t * (line.x1 - line.x0), line.y0 + t * (line.y1 - line.y0), x, y) ||
+			!project(line.x0 + next_t * (line.x1 - line.x0), line.y0 + next_t * (line.y1 - line.y0), next_x, next_y))
+			continue;
+
+		const double length = std::hypot(next_x - x, next_y - y);
+		if (length < 1e-9)
+			continue;
+		const double normal_x = -(next_y - y) / length, normal_y = (next_x - x) / length;
+
+		for (const double side : {-1.0, 1.0})
+		{
+			const int64_t col = std::lround(x + side * CONTROL_OFFSET * normal_x), row = std::lround(y + side * CONTROL_OFFSET * normal_y);
+			if (col < 0 || row < 0 || col >= image.width || row >= image.height)
+				continue;
+			samples++;
+			if (image.test(row * image.width + col))
+				hits++;
+		}
+	}
+	return hits;
+}
+
+/**
+ * @brief Classifies lines of a frame, reusing the last classification if the court model is verified in the frame.
+ * @param[in] image - Binarised image of the frame.
+ * @param[in] binary_image - Bit-packed form of the image.
+ * @return Classified line segments of the frame.
+ */
+std::vector<ClassifiedLineSegment> CourtTracker::classify(const Image &image, const BinaryImage &binary_image)
+{
+	if (model.verify(binary_image))
+	{
+		verified_frames++;
+		return cached_lines;
+	}
+
+	auto hough_transform = hough.create_hough_transform(binary_image);
+	auto hough_lines = hough.get_hough_lines(image, hough_transform, hough_threshold);
+	cached_lines = classifier.classify_lines(image, binary_image, hough_lines);
+	if (model.fit(cached_lines))
+		model.refine(binary_image);
+	classified_frames++;
+
+	return cached_lines;
+}
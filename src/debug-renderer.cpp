@@ -0,0 +1,251 @@
+#include <debug-renderer.h>
+#include <line-classifier.h>
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * @brief Starts a renderer which writes PNGs, named after the submission and a per-name sequence number.
+ * @param[in] output_directory - Directory to write PNGs to, which must exist.
+ * @param[in] max_pending - Optional argument, number of snapshots which may wait to be rendered before new ones are dropped.
+ */
+DebugRenderer::DebugRenderer(const std::string_view output_directory, const size_t max_pending)
+	: output_directory(output_directory), max_pending(max_pending), worker(&DebugRenderer::run, this)
+{
+}
+
+/**
+ * @brief Starts a renderer which passes rendered images to a viewer.
+ * @note The viewer is called from the rendering thread.
+ * @param[in] viewer - Function receiving the name of the submission and the rendered image.
+ * @param[in] max_pending - Optional argument, number of snapshots which may wait to be rendered before new ones are dropped.
+ */
+DebugRenderer::DebugRenderer(Viewer viewer, const size_t max_pending)
+	: viewer(std::move(viewer)), max_pending(max_pending), worker(&DebugRenderer::run, this)
+{
+}
+
+/**
+ * @brief Renders all pending snapshots, then stops the rendering thread.
+ */
+DebugRenderer::~DebugRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	pending_changed.notify_all();
+	worker.join();
+}
+
+/**
+ * @brief Submits a hough transform to be rendered with a colour map.
+ * @param[in] name - Name of the submission, used for the output file.
+ * @param[in] hough_transform - The hough transform, which is copied.
+ */
+void DebugRenderer::submit_hough_transform(const std::string_view name, const std::vector<std::vector<double>> &hough_transform)
+{
+	if (hough_transform.empty() || is_full())
+		return;
+
+	Snapshot snapshot;
+	snapshot.name = name;
+	snapshot.radii = hough_transform.size();
+	snapshot.angle_count = hough_transform.front().size();
+	snapshot.accumulator.reserve(snapshot.radii * snapshot.angle_count);
+	for (const std::vector<double> &row : hough_transform)
+		snapshot.accumulator.insert(snapshot.accumulator.end(), row.begin(), row.end());
+
+	enqueue(std::move(snapshot));
+}
+
+/**
+ * @brief Submits line segments to be drawn on top of an image.
+ * @param[in] name - Name of the submission, used for the output file.
+ * @param[in] image - Image to underlay lines on top of, which is copied.
+ * @param[in] lines - Line segments to draw.
+ * @param[in] classified - Flag indicating if lines should be drawn as classified lines, with labels.
+ * @param[in] intersections - Optional argument, intersections to mark on classified lines.
+ */
+void DebugRenderer::submit_lines(const std::string_view name, const Image &image, const std::vector<ClassifiedLineSegment> &lines,
+								 const bool classified, const std::vector<Coordinate::Cartesian> &intersections)
+{
+	if (is_full())
+		return;
+
+	Snapshot snapshot;
+	snapshot.name = name;
+	snapshot.samples = image.samples;
+	snapshot.width = image.width;
+	snapshot.height = image.height;
+	snapshot.lines = lines;
+	snapshot.intersections = intersections;
+	snapshot.classified = classified;
+
+	enqueue(std::move(snapshot));
+}
+
+/**
+ * @brief Blocks until all submitted snapshots have been rendered.
+ */
+void DebugRenderer::wait_until_idle()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	pending_changed.wait(lock, [this]
+						 { return pending.empty() && !rendering; });
+}
+
+/**
+ * @brief Maps a radius-major accumulator to a colour mapped image, with radius along the x-axis and angle along the y-axis.
+ * @param[in] accumulator - Votes of each cell, angle_count cells per radius.
+ * @param[in] radii - Number of radii.
+ * @param[in] angle_count - Number of angles.
+ * @return Rendered BGR image.
+ */
+cv::Mat DebugRenderer::render_hough_transform(const float *accumulator, const size_t radii, const size_t angle_count)
+{
+	const float max_votes = *std::max_element(accumulator, accumulator + radii * angle_count);
+	const float scale = (max_votes > 0.0f) ? 255.0f / max_votes : 0.0f;
+
+	cv::Mat intensity(static_cast<int>(angle_count), static_cast<int>(radii), CV_8UC1, cv::Scalar(0));
+	for (size_t j = 0; j < angle_count; j++)
+	{
+		uint8_t *row = intensity.ptr<uint8_t>(static_cast<int>(j));
+		for (size_t r = 0; r < radii; r++)
+			row[r] = static_cast<uint8_t>(accumulator[r * angle_count + j] * scale);
+	}
+
+	cv::Mat colour;
+	cv::applyColorMap(intensity, colour, cv::COLORMAP_INFERNO);
+	return colour;
+}
+
+/**
+ * @brief Maps a hough transform to a colour mapped image.
+ * @see DebugRenderer::render_hough_transform()
+ * @param[in] hough_transform - The hough transform to render.
+ * @return Rendered BGR image.
+ */
+cv::Mat DebugRenderer::render_hough_transform(const std::vector<std::vector<double>> &hough_transform)
+{
+	std::vector<float> accumulator;
+	accumulator.reserve(hough_transform.size() * hough_transform.front().size());
+	for (const std::vector<double> &row : hough_transform)
+		accumulator.insert(accumulator.end(), row.begin(), row.end());
+	return render_hough_transform(accumulator.data(), hough_transform.size(), hough_transform.front().size());
+}
+
+/**
+ * @brief Draws line segments on top of an image.
+ * @param[in] image - Image to underlay lines on top of.
+ * @param[in] lines - Line segments to draw.
+ * @return Rendered BGR image.
+ */
+cv::Mat DebugRenderer::render_line_segments(const Image &image, const std::vector<ClassifiedLineSegment> &lines)
+{
+	cv::Mat cv_img = image.convert_to_mat();
+	cv::cvtColor(cv_img, cv_img, cv::COLOR_GRAY2BGR);
+
+	for (const ClassifiedLineSegment &line : lines)
+		cv::line(cv_img, cv::Point(line.origin.x, line.origin.y), cv::Point(line.destination.x, line.destination.y), cv::Scalar(0, 0, 255), 5);
+	return cv_img;
+}
+
+/**
+ * @brief Checks if the queue is full, counting the snapshot as dropped if so, so it is not copied.
+ * @note Only an early exit, the queue may fill up before the snapshot is enqueued.
+ * @return Flag indicating if the snapshot should be dropped.
+ */
+bool DebugRenderer::is_full()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (pending.size() < max_pending)
+		return false;
+	dropped_snapshots++;
+	return true;
+}
+
+/**
+ * @brief Queues a snapshot for rendering, or drops it if max_pending snapshots are already queued.
+ * @details The check and the push are made under the same lock, so concurrent submissions never exceed max_pending.
+ * @param[in] snapshot - Snapshot to render.
+ */
+void DebugRenderer::enqueue(Snapshot &&snapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (pending.size() >= max_pending)
+		{
+			dropped_snapshots++;
+			return;
+		}
+		pending.push_back(std::move(snapshot));
+	}
+	pending_changed.notify_all();
+}
+
+/**
+ * @brief Rendering thread, renders snapshots in submission order until stopped and drained.
+ * @details Snapshots which fail to render, write or display are counted as dropped, and rendering continues.
+ */
+void DebugRenderer::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		pending_changed.wait(lock, [this]
+							 { return stopping || !pending.empty(); });
+		if (pending.empty())
+			return;
+
+		Snapshot snapshot = std::move(pending.front());
+		pending.pop_front();
+		rendering = true;
+
+		lock.unlock();
+		try
+		{
+			render(snapshot);
+		}
+		catch (...)
+		{
+			// A failed write or viewer must not terminate the pipeline, the snapshot is lost as if the queue had been full.
+			dropped_snapshots++;
+		}
+		lock.lock();
+
+		rendering = false;
+		pending_changed.notify_all();
+	}
+}
+
+/**
+ * @brief Renders a snapshot, and writes or shows the result.
+ * @note May throw, e.g. cv::Exception from OpenCV or any exception from the viewer.
+ * @param[in] snapshot - Snapshot to render.
+ */
+void DebugRenderer::render(const Snapshot &snapshot)
+{
+	cv::Mat rendered;
+	if (!snapshot.accumulator.empty())
+	{
+		rendered = render_hough_transform(snapshot.accumulator.data(), snapshot.radii, snapshot.angle_count);
+	}
+	else
+	{
+		const Image image(snapshot.samples, snapshot.width, snapshot.height);
+		rendered = snapshot.classified
+					   ? LineClassifier::draw_classified_lines(snapshot.lines, image, !snapshot.intersections.empty(), snapshot.intersections)
+					   : render_line_segments(image, snapshot.lines);
+	}
+
+	if (viewer)
+	{
+		viewer(snapshot.name, rendered);
+		return;
+	}
+
+	char sequence[16];
+	snprintf(sequence, sizeof(sequence), "-%06zu.png", name_counts[snapshot.name]++);
+	if (!cv::imwrite(output_directory + "/" + snapshot.name + sequence, rendered))
+		dropped_snapshots++;
+}
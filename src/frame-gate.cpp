@@ -0,0 +1,73 @@
+#include <frame-gate.h>
+#include <cstdlib>
+
+/**
+ * @brief Checks if a frame is unchanged since the last processed frame, within the tolerance.
+ * @param[in] image - Frame to check.
+ * @param[in] binarize_threshold - Threshold the frame is to be binarised at.
+ * @return Flag indicating if the cached classification of the last processed frame can be reused.
+ */
+bool FrameGate::is_unchanged(const Image &image, const uint32_t binarize_threshold) const
+{
+	if (!has_reference || image.width != reference_width || image.height != reference_height || binarize_threshold != reference_threshold)
+		return false;
+	if (tolerance <= 0.0)
+		return image.samples == reference_samples;
+
+	// Row by row, stopping once the remaining rows could not bring the mean back within the tolerance.
+	const double max_total = tolerance * reference_samples.size();
+	uint64_t total = 0;
+	size_t g = 0;
+	for (uint32_t row = 0; row < image.height; row += stride)
+	{
+		const uint8_t *samples = image.samples.data() + static_cast<size_t>(row) * image.width;
+		for (uint32_t col = 0; col < image.width; col += stride, g++)
+			total += std::abs(static_cast<int32_t>(samples[col]) - reference_samples[g]);
+		if (total > max_total)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Classifies a frame, reusing the last classification if the frame is unchanged.
+ * @details The frame is only binarised on a miss, so reused frames cost no more than the comparison.
+ * @param[in] image - 8-bit frame to classify, before binarisation.
+ * @param[in] binarize_threshold - Samples greater than the threshold are valid.
+ * @return Vector of line segments, which contain a classification.
+ */
+std::vector<ClassifiedLineSegment> FrameGate::classify(const Image &image, const uint32_t binarize_threshold)
+{
+	if (is_unchanged(image, binarize_threshold))
+	{
+		hits++;
+		return cached_lines;
+	}
+
+	const BinaryImage binary_image(image, binarize_threshold);
+	cached_lines = classifier.classify_lines(image, binary_image, hough.find_lines(image, binary_image, hough_threshold));
+	misses++;
+
+	has_reference = true;
+	reference_width = image.width;
+	reference_height = image.height;
+	reference_threshold = binarize_threshold;
+	reference_samples = (tolerance <= 0.0) ? image.samples : sample_grid(image);
+
+	return cached_lines;
+}
+
+/**
+ * @brief Subsamples a frame every stride rows and columns.
+ * @param[in] image - Frame to subsample.
+ * @return Subsampled samples, row by row.
+ */
+std::vector<uint8_t> FrameGate::sample_grid(const Image &image) const
+{
+	std::vector<uint8_t> grid;
+	grid.reserve(static_cast<size_t>((image.width + stride - 1) / stride) * ((image.height + stride - 1) / stride));
+	for (uint32_t row = 0; row < image.height; row += stride)
+		for (uint32_t col = 0; col < image.width; col += stride)
+			grid.push_back(image.samples[static_cast<size_t>(row) * image.width + col]);
+	return grid;
+}
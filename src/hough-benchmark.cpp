@@ -0,0 +1,143 @@
+#include <hough-benchmark.h>
+#include <binary-image.h>
+#include <hough.h>
+#include <replay-simulator.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static constexpr size_t MAX_NAIVE_BYTES = size_t(512) << 20; // The naive schedule holds every sample's radius for every angle.
+
+/**
+ * @brief Scales an image with nearest neighbour sampling, to benchmark larger frames with the same content.
+ */
+static Image scale_image(const Image &image, const double scale)
+{
+	const uint32_t width = static_cast<uint32_t>(image.width * scale), height = static_cast<uint32_t>(image.height * scale);
+	std::vector<uint8_t> samples(static_cast<size_t>(width) * height);
+	for (uint32_t row = 0; row < height; row++)
+		for (uint32_t col = 0; col < width; col++)
+			samples[static_cast<size_t>(row) * width + col] =
+				image.samples[static_cast<size_t>(row / scale) * image.width + static_cast<size_t>(col / scale)];
+	return Image(samples, width, height);
+}
+
+/**
+ * @brief Times the best of several transforms of a binary image with an angle tile.
+ * @return Milliseconds per transform.
+ */
+static double time_transform(Hough &hough, const BinaryImage &binary_image, const size_t tile, std::vector<std::vector<double>> &hough_transform)
+{
+	constexpr size_t REPEATS = 3;
+	hough.set_angle_tile(tile);
+
+	double best = 0.0;
+	for (size_t i = 0; i < REPEATS; i++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		hough_transform = hough.create_hough_transform(binary_image);
+		const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		best = (i == 0) ? elapsed : std::min(best, elapsed);
+	}
+	return best;
+}
+
+/**
+ * @brief Compares the throughput of tiles of angles against voting every angle per sample, at several image sizes.
+ * @details The image is scaled up to grow the accumulator and the sample count together. The baseline is a single tile of all 270
+ * angles, which is the naive loop order over the same accumulator. Each transform is checked to be identical to the original
+ * radius table transform (Hough::NAIVE_VOTING), where that fits in memory. Cache miss counts need an external profiler, e.g.
+ * perf stat -e cache-misses.
+ * @param[in] image - 8-bit image to scale and binarise.
+ * @param[in] binarize_threshold - Samples greater than the threshold are valid.
+ */
+void benchmark_hough_voting(const Image &image, const uint32_t binarize_threshold)
+{
+	const size_t angle_count = Hough::trig_table().size();
+
+	printf("%-11s %8s %6s %10s %6s %10s %12s %8s %9s\n", "Size", "Samples", "Radii", "Schedule", "Tile", "ms", "Mvotes/s", "Speedup", "Identical");
+	for (const double scale : {0.5, 1.0, 2.0, 3.0})
+	{
+		const Image scaled = scale_image(image, scale);
+		const BinaryImage binary_image(scaled, binarize_threshold);
+		const size_t samples = binary_image.count();
+		const size_t radii = static_cast<size_t>(std::hypot(static_cast<double>(scaled.height), static_cast<double>(scaled.width))) + 1;
+		const double mvotes = samples * angle_count / 1e6;
+		char size[32];
+		snprintf(size, sizeof(size), "%ux%u", scaled.width, scaled.height);
+
+		Hough hough;
+		std::vector<std::vector<double>> reference;
+		const bool has_reference = samples * angle_count * sizeof(double) <= MAX_NAIVE_BYTES;
+		if (has_reference)
+			time_transform(hough, binary_image, Hough::NAIVE_VOTING, reference);
+
+		double baseline_ms = 0.0;
+		const size_t auto_tile = Hough::auto_angle_tile(radii);
+		for (const size_t tile : {angle_count, size_t(1), size_t(8), size_t(32), auto_tile})
+		{
+			std::vector<std::vector<double>> hough_transform;
+			const double ms = time_transform(hough, binary_image, tile, hough_transform);
+			if (tile == angle_count)
+				baseline_ms = ms;
+
+			const char *schedule = (tile == angle_count) ? "untiled" : (tile == auto_tile) ? "auto" : "tiled";
+			printf("%-11s %8zu %6zu %10s %6zu %10.2f %12.1f %7.2fx %9s\n", size, samples, radii, schedule, tile, ms, mvotes / ms * 1e3,
+				   baseline_ms / ms, has_reference ? (hough_transform == reference ? "yes" : "NO") : "-");
+		}
+	}
+}
+
+/**
+ * @brief Compares batched transforms of 8 frames against 8 single frame transforms.
+ * @details Frames of a static camera are modelled by repeats of the image, where every sample is shared, and by the replay
+ * simulator's shifted and re-lit variants, where only part of the samples are shared. Each batch is checked to be identical to the
+ * single frame transforms, including the vote histograms.
+ * @param[in] image - 8-bit image to binarise.
+ * @param[in] binarize_threshold - Samples greater than the threshold are valid.
+ */
+void benchmark_hough_batch(const Image &image, const uint32_t binarize_threshold)
+{
+	constexpr size_t FRAMES = 8, REPEATS = 3;
+
+	printf("%-9s %7s %10s %10s %10s %8s %9s\n", "Frames", "Count", "Samples", "Single ms", "Batch ms", "Speedup", "Identical");
+	const std::vector<Image> variants = make_synthetic_variants(image, FRAMES);
+	for (const bool repeated : {true, false})
+	{
+		std::vector<BinaryImage> binary_images;
+		size_t samples = 0;
+		for (size_t k = 0; k < FRAMES; k++)
+		{
+			binary_images.emplace_back(repeated ? image : variants[k], binarize_threshold);
+			samples += binary_images.back().count();
+		}
+
+		Hough hough;
+		std::vector<std::vector<std::vector<double>>> single(FRAMES), batch;
+		std::vector<std::vector<uint32_t>> single_histograms(FRAMES), batch_histograms;
+		double single_ms = 0.0, batch_ms = 0.0;
+		for (size_t i = 0; i < REPEATS; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (size_t k = 0; k < FRAMES; k++)
+			{
+				single[k] = hough.create_hough_transform(binary_images[k]);
+				single_histograms[k] = hough.get_vote_histogram();
+			}
+			const double elapsed_single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			batch = hough.create_hough_transforms(binary_images, &batch_histograms);
+			const double elapsed_batch = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			single_ms = (i == 0) ? elapsed_single : std::min(single_ms, elapsed_single);
+			batch_ms = (i == 0) ? elapsed_batch : std::min(batch_ms, elapsed_batch);
+		}
+
+		const bool identical = batch == single && batch_histograms == single_histograms;
+		printf("%-9s %7zu %10zu %10.2f %10.2f %7.2fx %9s\n", repeated ? "repeated" : "variants", FRAMES, samples, single_ms, batch_ms,
+			   single_ms / batch_ms, identical ? "yes" : "NO");
+	}
+}
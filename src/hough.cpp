@@ -1,4 +1,116 @@
 #include <hough.h>
+#include <debug-renderer.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+/**
+ * @brief Extracts hough lines from an image, selecting the dense or sparse accumulator.
+ * @details The sparse accumulator is used when it would need less memory than a dense accumulator at the configured angular
+ * resolution, i.e. for large images with few valid samples. At 1 degree the dense accumulator is the usual hough transform.
+ * @param[in] img - Image to extract hough lines from, used for visualisation.
+ * @param[in] binary_image - Binary form of the image.
+ * @param[in] threshold - Optional argument that thresholds hough lines to be returned.
+ * @param[in] debug - Optional argument to enable visualisation of the transform.
+ * @return Hough lines of an image, which is a representation of harsh lines in the image.
+ */
+std::vector<Line> Hough::find_lines(const Image &img, const BinaryImage &binary_image, const double threshold, const bool debug)
+{
+	const std::vector<Coordinate::Cartesian> coordinates = binary_image.find_set_coordinates();
+	const bool use_sparse = use_sparse_accumulator(coordinates.size(), binary_image);
+	if (!use_sparse && angular_resolution == 1.0)
+		return get_hough_lines(img, vote(coordinates, binary_image.width, binary_image.height, debug), threshold, debug);
+
+	const size_t max_r = static_cast<size_t>(std::hypot(static_cast<double>(binary_image.height), static_cast<double>(binary_image.width)));
+	std::vector<Line> hough_lines = use_sparse ? find_lines_sparse(coordinates, max_r, threshold)
+											   : find_lines_dense(coordinates, binary_image.width, binary_image.height, threshold);
+	prune_lines(hough_lines);
+
+	if (debug)
+		show_hough_lines(hough_lines, img);
+
+	return hough_lines;
+}
+
+/**
+ * @brief Determines if the sparse accumulator should be used for an image.
+ * @details Votes of a line concentrate in few cells, so the number of voted cells is estimated as if samples were spread uniformly
+ * over the radii of each angle, which is the most cells they could occupy on average.
+ * @param[in] sample_count - Number of valid samples in the image.
+ * @param[in] image - Binary image to transform.
+ * @return Flag indicating if the sparse accumulator should be used.
+ */
+bool Hough::use_sparse_accumulator(const size_t sample_count, const BinaryImage &image) const
+{
+	const size_t angle_count = static_cast<size_t>(std::lround(ANGLE_RANGE / angular_resolution));
+	const double radii = std::floor(std::hypot(static_cast<double>(image.height), static_cast<double>(image.width))) + 1.0;
+	if (angle_count > SparseAccumulator::MAX_INDEX + 1 || radii > SparseAccumulator::MAX_INDEX + 1)
+		return false;
+	if (accumulator_backend != AccumulatorBackend::AUTO)
+		return accumulator_backend == AccumulatorBackend::SPARSE;
+
+	const double dense_bytes = radii * angle_count * sizeof(uint32_t);
+	const double expected_cells = angle_count * radii * -std::expm1(-static_cast<double>(sample_count) / radii);
+	return static_cast<double>(SparseAccumulator::memory_usage(static_cast<size_t>(expected_cells))) < dense_bytes;
+}
+
+/**
+ * @brief Votes valid samples into a sparse accumulator at the configured angular resolution, and extracts cells above the threshold.
+ * @note Angles are indexed from -90 degrees, so line angles match those of the dense transform.
+ * @param[in] coordinates - Cartesian coordinates of valid samples.
+ * @param[in] max_r - Largest possible radius, used to size the hash table.
+ * @param[in] threshold - Votes a cell must exceed to be returned as a line.
+ * @return Unpruned hough lines.
+ */
+std::vector<Line> Hough::find_lines_sparse(const std::vector<Coordinate::Cartesian> &coordinates, const size_t max_r, const double threshold)
+{
+	const std::vector<std::pair<double, double>> trig = trig_table(angular_resolution);
+	const double radii = static_cast<double>(max_r + 1);
+	SparseVotes accumulator = {SparseAccumulator(static_cast<size_t>(trig.size() * radii * -std::expm1(-static_cast<double>(coordinates.size()) / radii)))};
+
+	// A hash table has no slice to keep in cache, so all angles are voted as one tile.
+	vote_angles(coordinates, trig.data(), 0, trig.size(), accumulator);
+	accumulator.complete_histogram(trig.size());
+	vote_histogram = std::move(accumulator.histogram);
+
+	std::vector<SparseAccumulator::Cell> cells = accumulator.cells.cells_above(static_cast<uint32_t>(std::max(threshold, 0.0)));
+	std::sort(cells.begin(), cells.end(), [](const SparseAccumulator::Cell &a, const SparseAccumulator::Cell &b)
+			  { return (a.r != b.r) ? a.r < b.r : a.theta_index < b.theta_index; });
+
+	std::vector<Line> hough_lines;
+	for (const SparseAccumulator::Cell &cell : cells)
+		hough_lines.push_back(Line(Coordinate::Polar(static_cast<double>(cell.r), Degrees(cell.theta_index * angular_resolution))));
+	return hough_lines;
+}
+
+/**
+ * @brief Votes valid samples into a dense accumulator at the configured angular resolution, and extracts cells above the threshold.
+ * @note Angles are indexed from -90 degrees, so line angles match those of the hough transform.
+ * @param[in] coordinates - Cartesian coordinates of valid samples.
+ * @param[in] width - Width of the image.
+ * @param[in] height - Height of the image.
+ * @param[in] threshold - Votes a cell must exceed to be returned as a line.
+ * @return Unpruned hough lines.
+ */
+std::vector<Line> Hough::find_lines_dense(const std::vector<Coordinate::Cartesian> &coordinates, const uint32_t width, const uint32_t height,
+										  const double threshold)
+{
+	const std::vector<std::pair<double, double>> trig = trig_table(angular_resolution);
+	Accumulator accumulator(width, height, trig.size());
+	const size_t tile = resolve_angle_tile(accumulator.radii);
+	for (size_t angle_begin = 0; angle_begin < trig.size(); angle_begin += tile)
+		vote_angles(coordinates, trig.data(), angle_begin, std::min(angle_begin + tile, trig.size()), accumulator);
+
+	accumulator.complete_histogram();
+	vote_histogram = std::move(accumulator.histogram);
+
+	std::vector<Line> hough_lines;
+	for (size_t r = 0; r < accumulator.radii; r++)
+		for (size_t j = 0; j < trig.size(); j++)
+			if (accumulator.votes[j * accumulator.radii + r] > threshold)
+				hough_lines.push_back(Line(Coordinate::Polar(static_cast<double>(r), Degrees(j * angular_resolution))));
+	return hough_lines;
+}
 
 /**
  * @brief Creates hough transform of a given image.
@@ -8,8 +120,356 @@
  */
 std::vector<std::vector<double>> Hough::create_hough_transform(const Image &img, const bool debug)
 {
-	std::vector<Coordinate::Cartesian> coordinates = find_valid_sample_indices(img);
+	return vote(find_valid_sample_indices(img), img.width, img.height, debug);
+}
+
+/**
+ * @brief Creates hough transform of a bit-packed binary image.
+ * @param[in] img - Image to transform
+ * @param[in] debug - Optional argument to enable visualisation of the transform.
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> Hough::create_hough_transform(const BinaryImage &img, const bool debug)
+{
+	return vote(img.find_set_coordinates(), img.width, img.height, debug);
+}
+
+/**
+ * @brief Creates hough transforms of a batch of frames, sharing the voting work of samples set in several frames.
+ * @details Frames of a static camera share most of their set samples. Samples are merged across up to MAX_BATCH_FRAMES frames of
+ * the same size, each with a mask of the frames it is set in, and vote into an accumulator whose cells hold the votes of every frame
+ * of the batch. A merged sample calculates its radius once per angle, and adds its mask to the cell's votes of all frames at once.
+ * Frames whose size differs from the first frame's are transformed on their own.
+ * @see Hough::set_angle_tile()
+ * @param[in] images - Frames to transform, ideally of the same size.
+ * @param[out] vote_histograms - Optional argument, receives the vote histogram of each frame (see get_vote_histogram()).
+ * @return Hough transform of each frame, identical to create_hough_transform() of that frame.
+ */
+std::vector<std::vector<std::vector<double>>> Hough::create_hough_transforms(const std::vector<BinaryImage> &images,
+																			  std::vector<std::vector<uint32_t>> *vote_histograms) const
+{
+	const size_t frame_count = images.size();
+	std::vector<Accumulator> accumulators(frame_count);
+	std::vector<size_t> batch;
+	for (size_t k = 0; k < frame_count; k++)
+	{
+		if (images[k].width == images.front().width && images[k].height == images.front().height)
+			batch.push_back(k);
+		else
+			vote_single(images[k], accumulators[k]);
+
+		if (batch.size() == MAX_BATCH_FRAMES || (k + 1 == frame_count && !batch.empty()))
+		{
+			vote_batch(images, batch, accumulators);
+			batch.clear();
+		}
+	}
+
+	std::vector<std::vector<std::vector<double>>> hough_transforms(frame_count);
+	if (vote_histograms)
+		vote_histograms->resize(frame_count);
+	for (size_t k = 0; k < frame_count; k++)
+	{
+		accumulators[k].complete_histogram();
+		hough_transforms[k] = accumulators[k].to_hough_transform();
+		if (vote_histograms)
+			(*vote_histograms)[k] = std::move(accumulators[k].histogram);
+	}
+	return hough_transforms;
+}
+
+/**
+ * @brief Votes a single frame of a batch into its own accumulator.
+ * @param[in] image - Frame to transform.
+ * @param[out] accumulator - Accumulator of the frame.
+ */
+void Hough::vote_single(const BinaryImage &image, Accumulator &accumulator) const
+{
+	const std::vector<Coordinate::Cartesian> coordinates = image.find_set_coordinates();
+	accumulator = Accumulator(image.width, image.height);
+	const size_t tile = resolve_angle_tile(accumulator.radii);
+	for (size_t angle_begin = 0; angle_begin < angles.size(); angle_begin += tile)
+		vote_angles(coordinates, trig_table().data(), angle_begin, std::min(angle_begin + tile, angles.size()), accumulator);
+}
+
+/**
+ * @brief Votes up to MAX_BATCH_FRAMES frames of the same size through one shared accumulator.
+ * @details The vote histograms and largest radii are not maintained while voting, as that would be per frame work for every vote.
+ * They are derived from the final votes instead, whilst the shared accumulator is split into the accumulator of each frame.
+ * @param[in] images - Frames of the batch.
+ * @param[in] batch - Indices of the frames to vote, at most MAX_BATCH_FRAMES.
+ * @param[out] accumulators - Accumulators of all frames, of which those of the batch are populated.
+ */
+void Hough::vote_batch(const std::vector<BinaryImage> &images, const std::vector<size_t> &batch, std::vector<Accumulator> &accumulators) const
+{
+	const BinaryImage &first = images[batch.front()];
+
+	// Merge set samples in index order, with a mask of the batch frames they are set in.
+	std::vector<BatchSample> samples;
+	for (size_t w = 0; w < first.words.size(); w++)
+	{
+		uint64_t merged = 0;
+		for (const size_t k : batch)
+			merged |= images[k].words[w];
+
+		for (; merged != 0; merged &= merged - 1)
+		{
+			const size_t bit = std::countr_zero(merged);
+			BatchSample sample = {first.index_to_coordinate(static_cast<int32_t>(w * 64 + bit)), {}};
+			for (size_t i = 0; i < batch.size(); i++)
+				sample.frames[i] = (images[batch[i]].words[w] >> bit) & 1;
+			samples.push_back(sample);
+		}
+	}
+
+	const size_t radii = static_cast<size_t>(std::hypot(static_cast<double>(first.height), static_cast<double>(first.width))) + 1;
+	std::vector<uint32_t> votes(radii * angles.size() * MAX_BATCH_FRAMES, 0);
+	const size_t tile = resolve_angle_tile(radii * MAX_BATCH_FRAMES);
+	for (size_t angle_begin = 0; angle_begin < angles.size(); angle_begin += tile)
+		vote_angles_batch(samples, angle_begin, std::min(angle_begin + tile, angles.size()), radii, votes);
+
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		Accumulator &accumulator = accumulators[batch[i]];
+		accumulator = Accumulator(first.width, first.height);
+		size_t largest_radius = 0;
+		for (size_t cell = 0; cell < accumulator.votes.size(); cell++)
+		{
+			const uint32_t cell_votes = votes[cell * MAX_BATCH_FRAMES + i];
+			accumulator.votes[cell] = cell_votes;
+			if (cell_votes == 0)
+				continue;
+
+			if (cell_votes >= accumulator.histogram.size())
+				accumulator.histogram.resize(cell_votes + 1, 0);
+			accumulator.histogram[cell_votes]++;
+			accumulator.voted_cells++;
+			largest_radius = std::max(largest_radius, cell % radii);
+		}
+		accumulator.max_r = static_cast<double>(largest_radius);
+	}
+}
+
+/**
+ * @brief Votes merged samples for a tile of angles, the batch counterpart of vote_angles().
+ * @details Each cell holds MAX_BATCH_FRAMES consecutive vote counts, so a sample votes for all frames with one vector addition.
+ * @param[in] samples - Merged samples of the batch.
+ * @param[in] angle_begin - First angle index of the tile.
+ * @param[in] angle_end - One past the last angle index of the tile.
+ * @param[in] radii - Number of radii per angle of the accumulator.
+ * @param[in,out] votes - Angle-major accumulator of the batch, MAX_BATCH_FRAMES votes per cell.
+ */
+void Hough::vote_angles_batch(const std::vector<BatchSample> &samples, const size_t angle_begin, const size_t angle_end, const size_t radii,
+							  std::vector<uint32_t> &votes)
+{
+	const std::array<std::pair<double, double>, 270> &trig = trig_table();
+	const size_t angle_stride = radii * MAX_BATCH_FRAMES;
+
+	for (const BatchSample &sample : samples)
+	{
+		uint32_t *angle_votes = votes.data() + angle_begin * angle_stride;
+		for (size_t j = angle_begin; j < angle_end; j++, angle_votes += angle_stride)
+		{
+			const double r = sample.coordinate.x * trig[j].first + sample.coordinate.y * trig[j].second;
+			if (r < 0.0)
+				continue;
+
+			uint32_t *cell = angle_votes + static_cast<size_t>(r) * MAX_BATCH_FRAMES;
+			for (size_t k = 0; k < MAX_BATCH_FRAMES; k++)
+				cell[k] += sample.frames[k];
+		}
+	}
+}
 
+/**
+ * @brief Selects the number of angles to vote per pass over the samples, see Hough::set_angle_tile().
+ * @param[in] radii - Number of radii per angle of the accumulator.
+ * @return Number of angles per tile.
+ */
+size_t Hough::resolve_angle_tile(const size_t radii) const
+{
+	if (angle_tile != AUTO_ANGLE_TILE && angle_tile != NAIVE_VOTING)
+		return std::min(angle_tile, angles.size());
+	return auto_angle_tile(radii);
+}
+
+/**
+ * @brief Counts the cells without votes, for bin 0 of a vote histogram.
+ * @details The extent of every accumulator is that of the hough transform, the radii up to the largest radius voted for, so the
+ * histogram of an image does not depend on the accumulator it was voted into.
+ * @param[in] max_r - Largest radius voted for.
+ * @param[in] angle_count - Number of angles of the accumulator.
+ * @param[in] voted_cells - Number of cells with at least 1 vote.
+ * @return Number of cells without votes.
+ */
+uint32_t Hough::count_empty_cells(const double max_r, const size_t angle_count, const size_t voted_cells)
+{
+	return static_cast<uint32_t>(static_cast<size_t>(max_r + 1) * angle_count - voted_cells);
+}
+
+/**
+ * @brief Largest tile of angles whose accumulator slice fits the cache budget.
+ * @param[in] radii - Number of radii per angle of the accumulator.
+ * @return Number of angles per tile, at least 1.
+ */
+size_t Hough::auto_angle_tile(const size_t radii)
+{
+	return std::clamp<size_t>(CACHE_BUDGET_BYTES / (std::max<size_t>(radii, 1) * sizeof(uint32_t)), 1, angles.size());
+}
+
+/**
+ * @brief Allocates an empty angle-major accumulator, with a radius bin for every radius within the image diagonal.
+ * @param[in] width - Width of the image.
+ * @param[in] height - Height of the image.
+ * @param[in] angle_count - Optional argument, number of angles, only the default of 1 degree angles converts to a hough transform.
+ */
+Hough::Accumulator::Accumulator(const uint32_t width, const uint32_t height, const size_t angle_count)
+	: radii(static_cast<size_t>(std::hypot(static_cast<double>(height), static_cast<double>(width))) + 1),
+	  votes(radii * angle_count, 0), histogram(2, 0)
+{
+}
+
+/**
+ * @brief Counts the cells without votes in the vote histogram, once voting is complete.
+ */
+void Hough::Accumulator::complete_histogram()
+{
+	histogram[0] = count_empty_cells(max_r, votes.size() / radii, voted_cells);
+}
+
+/**
+ * @brief Converts the accumulator to the radius-major hough transform, trimmed to the largest radius.
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> Hough::Accumulator::to_hough_transform() const
+{
+	const size_t rows = static_cast<size_t>(max_r + 1);
+	std::vector<std::vector<double>> hough_transform(rows, std::vector<double>(angles.size()));
+	for (size_t j = 0; j < angles.size(); j++)
+	{
+		const uint32_t *angle_votes = votes.data() + j * radii;
+		for (size_t r = 0; r < rows; r++)
+			hough_transform[r][j] = angle_votes[r];
+	}
+	return hough_transform;
+}
+
+/**
+ * @brief Votes all samples for a tile of angles, the voting kernel of every transform other than the batch transform.
+ * @details Each sample votes for every angle of the tile before moving to the next sample, so only the tile's slice of the
+ * accumulator is written whilst the samples stream through once. The vote histogram is maintained alongside voting, moving a cell
+ * from bin n to n+1 per vote, so selecting a threshold never requires another pass over the accumulator.
+ * @param[in] coordinates - Cartesian coordinates of valid samples.
+ * @param[in] trig - Cosine and sine of each angle of the accumulator.
+ * @param[in] angle_begin - First angle index of the tile.
+ * @param[in] angle_end - One past the last angle index of the tile.
+ * @param[in,out] accumulator - Accumulator to vote into, Hough::Accumulator or Hough::SparseVotes.
+ */
+template <typename VoteAccumulator>
+void Hough::vote_angles(const std::vector<Coordinate::Cartesian> &coordinates, const std::pair<double, double> *trig, const size_t angle_begin,
+						const size_t angle_end, VoteAccumulator &accumulator)
+{
+	std::vector<uint32_t> &histogram = accumulator.histogram;
+	double max_r = accumulator.max_r;
+
+	for (const Coordinate::Cartesian &coordinate : coordinates)
+	{
+		for (size_t j = angle_begin; j < angle_end; j++)
+		{
+			const double r = coordinate.x * trig[j].first + coordinate.y * trig[j].second;
+			if (r > max_r)
+				max_r = r;
+			if (r < 0.0)
+				continue;
+
+			const uint32_t votes = accumulator.increment(j, static_cast<size_t>(r));
+			if (votes + 1 >= histogram.size())
+				histogram.resize(votes + 2, 0);
+			if (votes == 0)
+				accumulator.voted_cells++;
+			else
+				histogram[votes]--;
+			histogram[votes + 1]++;
+		}
+	}
+	accumulator.max_r = max_r;
+}
+
+template void Hough::vote_angles<Hough::Accumulator>(const std::vector<Coordinate::Cartesian> &, const std::pair<double, double> *, const size_t,
+													 const size_t, Hough::Accumulator &);
+template void Hough::vote_angles<Hough::SparseVotes>(const std::vector<Coordinate::Cartesian> &, const std::pair<double, double> *, const size_t,
+													 const size_t, Hough::SparseVotes &);
+
+/**
+ * @brief Cosine and sine of each hough angle, calculated once and shared by all transforms.
+ * @return Pairs of cosine and sine, indexed as Hough::angles.
+ */
+const std::array<std::pair<double, double>, 270> &Hough::trig_table()
+{
+	static const std::array<std::pair<double, double>, 270> table = []
+	{
+		std::array<std::pair<double, double>, 270> table;
+		for (size_t j = 0; j < angles.size(); j++)
+			table[j] = {std::cos(angles[j]), std::sin(angles[j])};
+		return table;
+	}();
+	return table;
+}
+
+/**
+ * @brief Cosine and sine of each angle at an angular resolution, indexed from -90 degrees.
+ * @param[in] angular_resolution - Step between angles.
+ * @return Pairs of cosine and sine, covering the same range as Hough::angles.
+ */
+std::vector<std::pair<double, double>> Hough::trig_table(const Degrees angular_resolution)
+{
+	std::vector<std::pair<double, double>> table(static_cast<size_t>(std::lround(ANGLE_RANGE / angular_resolution)));
+	for (size_t j = 0; j < table.size(); j++)
+	{
+		const Radians theta = deg_to_radians(j * angular_resolution - 90.0);
+		table[j] = {std::cos(theta), std::sin(theta)};
+	}
+	return table;
+}
+
+/**
+ * @brief Votes all valid samples into the hough transform, a tile of angles at a time.
+ * @see Hough::set_angle_tile()
+ * @param[in] coordinates - Cartesian coordinates of valid samples.
+ * @param[in] width - Width of the image.
+ * @param[in] height - Height of the image.
+ * @param[in] debug - Enables visualisation of the transform.
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> Hough::vote(const std::vector<Coordinate::Cartesian> &coordinates, const uint32_t width, const uint32_t height,
+											  const bool debug)
+{
+	if (angle_tile == NAIVE_VOTING)
+		return vote_naive(coordinates, debug);
+
+	Accumulator accumulator(width, height);
+	const size_t tile = resolve_angle_tile(accumulator.radii);
+	for (size_t angle_begin = 0; angle_begin < angles.size(); angle_begin += tile)
+		vote_angles(coordinates, trig_table().data(), angle_begin, std::min(angle_begin + tile, angles.size()), accumulator);
+
+	accumulator.complete_histogram();
+	std::vector<std::vector<double>> hough_transform = accumulator.to_hough_transform();
+	vote_histogram = std::move(accumulator.histogram);
+	if (debug)
+		show_hough_transform(hough_transform);
+
+	return hough_transform;
+}
+
+/**
+ * @brief Votes all valid samples into the hough transform, in sample order over every angle.
+ * @note Kept as the reference for the tiled schedule, see Hough::NAIVE_VOTING.
+ * @param[in] coordinates - Cartesian coordinates of valid samples.
+ * @param[in] debug - Enables visualisation of the transform.
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> Hough::vote_naive(const std::vector<Coordinate::Cartesian> &coordinates, const bool debug)
+{
 	std::vector<std::vector<double>> r(coordinates.size(), std::vector<double>(angles.size()));
 	for (size_t i = 0; i < coordinates.size(); i++)
 		for (size_t j = 0; j < angles.size(); j++)
@@ -17,10 +477,25 @@ std::vector<std::vector<double>> Hough::create_hough_transform(const Image &img,
 
 	double max_r = find_max_element(r);
 	std::vector<std::vector<double>> hough_transform(max_r + 1, std::vector<double>(angles.size()));
+
+	// The vote histogram is maintained alongside voting, moving a cell from bin n to n+1 per vote, so selecting a threshold
+	// never requires another pass over the accumulator.
+	vote_histogram.assign(2, 0);
+	size_t voted_cells = 0;
 	for (size_t i = 0; i < coordinates.size(); i++)
 		for (size_t j = 0; j < angles.size(); j++)
 			if (r[i][j] >= 0.0f)
-				hough_transform[r[i][j]][j]++;
+			{
+				const size_t votes = static_cast<size_t>(hough_transform[r[i][j]][j]++);
+				if (votes + 1 >= vote_histogram.size())
+					vote_histogram.resize(votes + 2, 0);
+				if (votes == 0)
+					voted_cells++;
+				else
+					vote_histogram[votes]--;
+				vote_histogram[votes + 1]++;
+			}
+	vote_histogram[0] = static_cast<uint32_t>(hough_transform.size() * angles.size() - voted_cells);
 	if (debug)
 		show_hough_transform(hough_transform);
 
@@ -52,6 +527,42 @@ std::vector<Line> Hough::get_hough_lines(const Image &img, const std::vector<std
 	return hough_lines;
 }
 
+/**
+ * @brief Extracts hough lines from an image, using a threshold derived from the vote histogram of its transform.
+ * @param[in] img - Image to extract hough lines from
+ * @param[in] hough_transform - The hough transformed image
+ * @param[in] vote_histogram - Vote histogram of hough_transform, see get_vote_histogram().
+ * @param[in] max_candidates - Optional argument that limits the number of candidate lines prior to pruning.
+ * @param[in] debug - Optional argument to enable visualisation of the transform.
+ * @return Hough lines of an image, which is a representation of harsh lines in the image.
+ */
+std::vector<Line> Hough::get_hough_lines(const Image &img, const std::vector<std::vector<double>> &hough_transform, const std::vector<uint32_t> &vote_histogram,
+										 const size_t max_candidates, const bool debug) const
+{
+	return get_hough_lines(img, hough_transform, select_threshold(vote_histogram, max_candidates), debug);
+}
+
+/**
+ * @brief Selects the lowest hough line threshold which yields no more than a number of candidate lines, from a histogram of
+ * accumulator values.
+ * @details Lines are extracted from cells with more votes than the threshold, so the candidate count of a threshold is the sum of
+ * all histogram bins above it. The threshold keeps pruning bounded regardless of how many edge samples survive binarisation.
+ * @param[in] vote_histogram - Number of accumulator cells for each vote count.
+ * @param[in] max_candidates - Maximum number of candidate lines.
+ * @return Threshold to extract hough lines with.
+ */
+double Hough::select_threshold(const std::vector<uint32_t> &vote_histogram, const size_t max_candidates)
+{
+	size_t candidates = 0;
+	for (size_t votes = vote_histogram.size(); votes-- > 1;)
+	{
+		candidates += vote_histogram[votes];
+		if (candidates > max_candidates)
+			return static_cast<double>(votes);
+	}
+	return 0.0;
+}
+
 /**
  * @brief Finds all non 0 (non black) samples indices of an image.
  * @param[in] img - Image to transform.
@@ -129,34 +640,33 @@ bool Hough::is_similar(const Line &line_a, const Line &line_b) const
 }
 
 /**
- * @brief Displays hough transform using Open CV.
+ * @brief Displays hough transform using Open CV, or submits it to the debug renderer if one is set.
  * @note OpenCV's WaitKey function is required after in order to display.
  * @param[in] hough_transform - The hough transform to display
  */
 void Hough::show_hough_transform(const std::vector<std::vector<double>> &hough_transform) const
 {
-	cv::Mat cv_image(hough_transform.front().size(), hough_transform.size(), CV_8UC3, cv::Scalar(0, 0, 0));
-	for (size_t i = 0; i < hough_transform.size(); i++)
-		for (size_t j = 0; j < hough_transform.front().size(); j++)
-			cv::drawMarker(cv_image, cv::Point(i, j), cv::Scalar(0, 0, hough_transform[i][j] * 3), 4, 1, 1);
-	cv::imshow("Hough Transform", cv_image);
+	if (debug_renderer)
+		debug_renderer->submit_hough_transform("hough-transform", hough_transform);
+	else
+		cv::imshow("Hough Transform", DebugRenderer::render_hough_transform(hough_transform));
 }
 
 /**
- * @brief Displays hough lines using Open CV.
+ * @brief Displays hough lines using Open CV, or submits them to the debug renderer if one is set.
  * @note OpenCV's WaitKey function is required after in order to display.
  * @param[in] hough_lines - The hough lines to display
  * @param[in] image - The image where lines will be drawn on top of.
  */
 void Hough::show_hough_lines(const std::vector<Line> &hough_lines, const Image &image) const
 {
-	cv::Mat cv_img = image.convert_to_mat();
-	cv::cvtColor(cv_img, cv_img, cv::COLOR_GRAY2BGR);
-
+	std::vector<ClassifiedLineSegment> line_segments;
+	line_segments.reserve(hough_lines.size());
 	for (const Line &line : hough_lines)
-	{
-		ClassifiedLineSegment line_seg = line.to_line_segment();
-		cv::line(cv_img, cv::Point(line_seg.origin.x, line_seg.origin.y), cv::Point(line_seg.destination.x, line_seg.destination.y), cv::Scalar(0, 0, 255), 5);
-	}
-	cv::imshow("Hough Lines", cv_img);
-}
\ No newline at end of file
+		line_segments.push_back(line.to_line_segment());
+
+	if (debug_renderer)
+		debug_renderer->submit_lines("hough-lines", image, line_segments, false);
+	else
+		cv::imshow("Hough Lines", DebugRenderer::render_line_segments(image, line_segments));
+}
@@ -6,6 +6,7 @@
 #include <numbers>
 #include <fstream>
 #include <structs.h>
+#include <debug-renderer.h>
 
 /**
  * @brief Classifies lines of a tennis court using hough lines.
@@ -19,33 +20,46 @@
  * @return Vector of line segments, which contain a classification.
  */
 std::vector<ClassifiedLineSegment> LineClassifier::classify_lines(const Image& image, std::vector<Line> hough_lines, const bool debug)
+{
+	return classify_lines(image, BinaryImage(image), std::move(hough_lines), debug);
+}
+
+/**
+ * @brief Classifies lines of a tennis court using hough lines, with a pre-packed binary image for ROI checks.
+ * @see LineClassifier::classify_lines()
+ * @param[in] image - The image of which lines are being classified.
+ * @param[in] binary_image - Bit-packed binary form of the image, used to check if lines continue.
+ * @param[in] hough_lines - The hough lines which represent clear lines in the image.
+ * @param[in] debug - Optional argument to enable visualisation of preprocessed data.
+ * @return Vector of line segments, which contain a classification.
+ */
+std::vector<ClassifiedLineSegment> LineClassifier::classify_lines(const Image& image, const BinaryImage& binary_image, std::vector<Line> hough_lines, const bool debug)
 {
 	auto line_intersections_map = get_intersections(hough_lines);
-	auto debug_intersections = line_intersections_map; //create copy for visualisation of all intersections, prior to pruning.
 
-	remove_false_horz_line_intersections(line_intersections_map, image);
+	// Flatten all intersections for visualisation, prior to pruning.
+	std::vector<Coordinate::Cartesian> all_intersection_coords;
+	if (debug)
+		for (const auto& i : line_intersections_map)
+			all_intersection_coords.insert(all_intersection_coords.end(), i.second.begin(), i.second.end());
+
+	remove_false_horz_line_intersections(line_intersections_map, binary_image);
 
 	std::vector<ClassifiedLineSegment> classified_lines = classify_horz_lines(line_intersections_map);
 	classified_lines = classify_vert_lines(line_intersections_map, classified_lines);
 
-	cv::Mat debug_image = image.convert_to_mat();
-	cv::cvtColor(debug_image, debug_image, cv::COLOR_GRAY2BGR);
-
 	if (debug)
 	{
-		std::vector<Coordinate::Cartesian> all_intersection_coords(debug_intersections.size());
-		for (auto i : debug_intersections)
-			all_intersection_coords.insert(all_intersection_coords.begin(), i.second.begin(), i.second.end());
-		show_classified_lines(classified_lines, image, true, all_intersection_coords);
-	}
-	else
-	{
-		std::vector<Coordinate::Cartesian> pruned_intersection_coords(line_intersections_map.size());
-		for (auto i : line_intersections_map)
-			pruned_intersection_coords.insert(pruned_intersection_coords.begin(), i.second.begin(), i.second.end());
-		show_classified_lines(classified_lines, image, false);
+		if (debug_renderer)
+		{
+			debug_renderer->submit_lines("classified-lines", image, classified_lines, true, all_intersection_coords);
+		}
+		else
+		{
+			show_classified_lines(classified_lines, image, true, all_intersection_coords);
+			cv::waitKey();
+		}
 	}
-	cv::waitKey();
 
 	return classified_lines;
 }
@@ -129,7 +143,7 @@ Coordinate::Cartesian LineClassifier::get_intersection(const Line& lineA, const
  */
 void LineClassifier::remove_false_horz_line_intersections(std::unordered_map<Line, std::vector<Coordinate::Cartesian>,
 	container_hash, container_equal>& intersections,
-	const Image& image)
+	const BinaryImage& image)
 {
 	for (auto it = intersections.begin(); it != intersections.end(); it++)
 	{
@@ -227,6 +241,10 @@ std::vector<ClassifiedLineSegment> LineClassifier::classify_vert_lines(const std
 
 	for (auto& it : vertical_intersections)
 	{
+		// The top of the image is extrapolated through the first 2 intersections, so lines with fewer cannot be classified.
+		if (it.second.size() < 2)
+			continue;
+
 		for (Coordinate::Cartesian intersection : it.second)
 		{
 			// 2 Singles Sideline
@@ -292,11 +310,28 @@ Coordinate::Cartesian LineClassifier::get_upper_image_intercept(const Coordinate
 /**
  * @brief Displays classified lines using OpenCV.
  * @note The OpenCV function WaitKey is required after this function to properly display the image.
+ * @see LineClassifier::draw_classified_lines()
  * @param[in] lines - Classified lines to draw.
  * @param[in] image - Image to underlay lines on top of.
+ * @param[in] show_markers - Flag to draw a marker at each intersection.
+ * @param[in] intersections - Optional argument, intersections to mark.
  */
 void LineClassifier::show_classified_lines(const std::vector<ClassifiedLineSegment>& lines,
 	const Image& image, const bool show_markers, const std::vector<Coordinate::Cartesian>& intersections) const
+{
+	cv::imshow("Classified Lines", draw_classified_lines(lines, image, show_markers, intersections));
+}
+
+/**
+ * @brief Draws classified lines, labelled with their class, on top of an image.
+ * @param[in] lines - Classified lines to draw.
+ * @param[in] image - Image to underlay lines on top of.
+ * @param[in] show_markers - Flag to draw a marker at each intersection.
+ * @param[in] intersections - Optional argument, intersections to mark.
+ * @return Rendered BGR image.
+ */
+cv::Mat LineClassifier::draw_classified_lines(const std::vector<ClassifiedLineSegment>& lines,
+	const Image& image, const bool show_markers, const std::vector<Coordinate::Cartesian>& intersections)
 {
 	cv::Mat cv = image.convert_to_mat();
 	cv::cvtColor(cv, cv, cv::COLOR_GRAY2BGR);
@@ -333,5 +368,5 @@ void LineClassifier::show_classified_lines(const std::vector<ClassifiedLineSegme
 		for (const Coordinate::Cartesian intersection : intersections)
 			cv::drawMarker(cv, cv::Point(intersection.x, intersection.y), cv::Scalar(0, 0, 255), 0, 20, 8);
 
-	cv::imshow("Classified Lines", cv);
-};
\ No newline at end of file
+	return cv;
+}
\ No newline at end of file
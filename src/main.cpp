@@ -2,11 +2,22 @@
 #include <hough.h>
 #include <line-classifier.h>
 #include <opencv2/opencv.hpp>
-#include <fstream>
+#include <result-sink.h>
+#include <parameter-sweep.h>
+#include <replay-simulator.h>
+#include <rle-frame.h>
+#include <hough-benchmark.h>
+#include <self-check.h>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
 
 // Provided Image Details
 constexpr int32_t image_width = 1392, image_height = 550;
 constexpr std::string_view image_path = "res/image.raw";
+constexpr std::string_view baseline_path = "res/regression-baseline.csv"; // Pipeline output for image_path at the default thresholds, kept apart from results.csv which every run overwrites.
 
 void binarize(Image& img, const uint32_t threshold)
 {
@@ -14,52 +25,159 @@ void binarize(Image& img, const uint32_t threshold)
 		sample = (sample > threshold) ? 255 : 0;
 }
 
-void write_lines_to_csv(const std::vector<ClassifiedLineSegment>& lines)
+/**
+ * @brief Parses a whole command line argument as a number within a range.
+ * @param[in] text - Argument to parse.
+ * @param[in] min - Smallest valid value.
+ * @param[in] max - Largest valid value.
+ * @param[out] value - Parsed value, only written if valid.
+ * @return Flag indicating if the argument is a number within the range.
+ */
+template <typename T>
+bool parse_argument(const std::string_view text, const T min, const T max, T &value)
 {
-	std::ofstream myfile;
-	myfile.open("results.csv");
-	myfile << "Line," << "X" << "," << "Y" << "," << "X" << "," << "Y" << ",\n";
+	T parsed;
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+	if (error != std::errc() || end != text.data() + text.size() || !(parsed >= min && parsed <= max))
+		return false;
+	value = parsed;
+	return true;
+}
+
+/**
+ * @brief Sweeps binarisation and hough thresholds around the defaults, scoring each pair against reference lines.
+ * @note The default reference is the regression baseline, the pipeline's own output at the default thresholds, so scores measure
+ * agreement with the defaults rather than accuracy. Pass hand-labelled lines to measure accuracy.
+ * @param[in] reference_path - CSV of expected lines, in the format of results.csv.
+ * @return Process exit code.
+ */
+int sweep(const std::string_view reference_path)
+{
+	const std::vector<ClassifiedLineSegment> reference = read_csv_results(reference_path);
+	if (reference.empty())
+	{
+		std::cerr << "No reference lines in " << reference_path << "\n";
+		return 1;
+	}
+
+	std::vector<uint32_t> binarize_thresholds;
+	for (uint32_t threshold = 100; threshold <= 200; threshold += 10)
+		binarize_thresholds.push_back(threshold);
+	std::vector<double> hough_thresholds;
+	for (double threshold = 150; threshold <= 250; threshold += 10)
+		hough_thresholds.push_back(threshold);
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector<SweepResult> results = sweep_thresholds(Image(image_path, image_width, image_height), binarize_thresholds, hough_thresholds, reference);
+	const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+	print_sweep_results(results);
+	std::cerr << results.size() << " threshold pairs in " << elapsed.count() << " ms\n";
+	return 0;
+}
+
+/**
+ * @brief Replays recorded frames at camera rates, reporting whether the pipeline keeps up.
+ * @details Without frame paths, the image and synthetic variants of it are replayed.
+ * @param[in] argc - Number of optional arguments.
+ * @param[in] argv - Optional stream count, frames per second per stream, duration in seconds and worker count, then optionally the
+ * width and height of the frames followed by the paths of .raw frames.
+ * @return Process exit code, 2 if any frame was dropped.
+ */
+int replay(const int argc, char *argv[])
+{
+	ReplayConfig config;
+	if (argc > 0 && !parse_argument<size_t>(argv[0], 1, 1024, config.stream_count))
+	{
+		std::cerr << "Invalid stream count " << argv[0] << ", expected 1 to 1024\n";
+		return 1;
+	}
+	if (argc > 1 && !parse_argument(argv[1], 0.001, 10000.0, config.frames_per_second))
+	{
+		std::cerr << "Invalid frame rate " << argv[1] << ", expected 0.001 to 10000 frames per second\n";
+		return 1;
+	}
+	if (argc > 2 && !parse_argument(argv[2], 0.001, 86400.0, config.duration_seconds))
+	{
+		std::cerr << "Invalid duration " << argv[2] << ", expected 0.001 to 86400 seconds\n";
+		return 1;
+	}
+	if (argc > 3 && !parse_argument<size_t>(argv[3], 0, 1024, config.worker_count))
+	{
+		std::cerr << "Invalid worker count " << argv[3] << ", expected 0 (one per hardware thread) to 1024\n";
+		return 1;
+	}
 
-	for (const ClassifiedLineSegment& line : lines)
+	std::vector<Image> frames;
+	if (argc > 4)
 	{
-		switch (line.line_class)
+		uint32_t width = 0, height = 0;
+		if (argc < 7 || !parse_argument<uint32_t>(argv[4], 1, 65535, width) || !parse_argument<uint32_t>(argv[5], 1, 65535, height))
 		{
-		case LineClasses::INNER_BASE_LINE:
-			myfile << "Base Line," << line.origin.x << "," << line.origin.y << "," << line.destination.x << "," << line.destination.y << ",\n";
-			break;
-		case LineClasses::SERVICE_LINE:
-			myfile << "Service Line," << line.origin.x << "," << line.origin.y << "," << line.destination.x << "," << line.destination.y << ",\n";
-			break;
-		case LineClasses::CENTRE_SERVICE_LINE:
-			myfile << "Centre Service Line," << line.origin.x << "," << line.origin.y << "," << line.destination.x << "," << line.destination.y << ",\n";
-
-			break;
-		case LineClasses::DOUBLES_SIDELINE:
-			myfile << "Doubles Side Line," << line.origin.x << "," << line.origin.y << "," << line.destination.x << "," << line.destination.y << ",\n";
-			break;
-		case LineClasses::SINGLES_SIDELINE:
-			myfile << "Singles Side Line," << line.origin.x << "," << line.origin.y << "," << line.destination.x << "," << line.destination.y << ",\n";
-			break;
-		default:
-			break;
+			std::cerr << "Expected a frame width and height of 1 to 65535, followed by at least one .raw frame\n";
+			return 1;
 		}
+		if (!load_raw_frames(std::vector<std::string_view>(argv + 6, argv + argc), width, height, frames))
+			return 1;
+	}
+	else
+	{
+		frames = make_synthetic_variants(Image(image_path, image_width, image_height), 16);
 	}
-	myfile.close();
+
+	ReplaySimulator simulator(std::move(frames), config);
+	const ReplayReport report = simulator.run();
+	report.print();
+	return report.frames_dropped() ? 2 : 0;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+	if (argc == 3 && std::string_view(argv[1]) == "read-log")
+		return print_binary_log(argv[2]);
+	if ((argc == 3 || argc == 4) && std::string_view(argv[1]) == "encode-rle")
+	{
+		uint32_t floor = 0;
+		if (argc == 4 && !parse_argument<uint32_t>(argv[3], 0, 255, floor))
+		{
+			std::cerr << "Invalid floor " << argv[3] << ", expected 0 to 255\n";
+			return 1;
+		}
+		return write_rle_frame(argv[2], Image(image_path, image_width, image_height), static_cast<uint8_t>(floor)) ? 0 : 1;
+	}
+	if (argc == 2 && std::string_view(argv[1]) == "benchmark-hough")
+	{
+		benchmark_hough_voting(Image(image_path, image_width, image_height), 150);
+		return 0;
+	}
+	if (argc == 2 && std::string_view(argv[1]) == "benchmark-hough-batch")
+	{
+		benchmark_hough_batch(Image(image_path, image_width, image_height), 150);
+		return 0;
+	}
+	if ((argc == 2 || argc == 3) && std::string_view(argv[1]) == "check")
+		return run_self_checks(Image(image_path, image_width, image_height), 150, argc == 3 ? argv[2] : "");
+	if (argc >= 2 && std::string_view(argv[1]) == "replay")
+		return replay(argc - 2, argv + 2);
+	if (argc >= 2 && std::string_view(argv[1]) == "sweep")
+		return sweep(argc == 3 ? argv[2] : baseline_path);
+
 	Image img("res/image.raw", image_width, image_height);
 
 	binarize(img, 150);
+	BinaryImage binary_img(img);
 
 	Hough hough_transformer;
-	auto hough_transform = hough_transformer.create_hough_transform(img, true);
+	auto hough_transform = hough_transformer.create_hough_transform(binary_img, true);
 	auto hough_lines = hough_transformer.get_hough_lines(img, hough_transform, 200, true);
 
 	LineClassifier classifier;
-	std::vector<ClassifiedLineSegment> lines = classifier.classify_lines(img, hough_lines);
+	std::vector<ClassifiedLineSegment> lines = classifier.classify_lines(img, binary_img, hough_lines);
+
+	CsvResultSink csv_sink("results.csv");
+	csv_sink.write(0, 0, lines);
+	csv_sink.flush();
 
-	write_lines_to_csv(lines);
+	classifier.show_classified_lines(lines, img, false);
 	cv::waitKey();
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <parameter-sweep.h>
+#include <binary-image.h>
+#include <hough.h>
+#include <line-classifier.h>
+#include <stratified-hough.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static constexpr double MATCH_TOLERANCE = 10.0; // Maximum endpoint error of a matched line, in pixels.
+
+/**
+ * @brief Endpoint error between 2 line segments, regardless of their direction.
+ * @return Larger of the 2 endpoint distances.
+ */
+static double line_error(const ClassifiedLineSegment &a, const ClassifiedLineSegment &b)
+{
+	const auto distance = [](const Coordinate::Cartesian p1, const Coordinate::Cartesian p2)
+	{ return std::hypot(static_cast<double>(p1.x - p2.x), static_cast<double>(p1.y - p2.y)); };
+
+	return std::min(std::max(distance(a.origin, b.origin), distance(a.destination, b.destination)),
+					std::max(distance(a.origin, b.destination), distance(a.destination, b.origin)));
+}
+
+/**
+ * @brief Scores classified lines against ground truth, greedily matching each ground truth line to the closest unmatched line of its class.
+ */
+static void score_lines(const std::vector<ClassifiedLineSegment> &lines, const std::vector<ClassifiedLineSegment> &ground_truth, SweepResult &result)
+{
+	std::vector<bool> used(lines.size(), false);
+	double total_error = 0.0;
+	result.matched_lines = 0;
+
+	for (const ClassifiedLineSegment &truth : ground_truth)
+	{
+		size_t best = lines.size();
+		double best_error = MATCH_TOLERANCE;
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			if (used[i] || lines[i].line_class != truth.line_class)
+				continue;
+			const double error = line_error(lines[i], truth);
+			if (error <= best_error)
+			{
+				best = i;
+				best_error = error;
+			}
+		}
+		if (best == lines.size())
+			continue;
+
+		used[best] = true;
+		total_error += best_error;
+		result.matched_lines++;
+	}
+
+	result.false_lines = 0;
+	for (size_t i = 0; i < lines.size(); i++)
+		if (!used[i] && std::any_of(ground_truth.begin(), ground_truth.end(), [&](const ClassifiedLineSegment &truth)
+									{ return truth.line_class == lines[i].line_class; }))
+			result.false_lines++;
+
+	result.mean_error = result.matched_lines ? total_error / result.matched_lines : 0.0;
+}
+
+/**
+ * @brief Runs the pipeline for every pair of binarisation and hough thresholds, scoring each against ground truth.
+ * @details The image is voted once into a StratifiedHough, so each binarisation threshold only costs a copy of its accumulator,
+ * and each hough threshold only the line extraction and classification.
+ * @param[in] image - 8-bit image, before binarisation.
+ * @param[in] binarize_thresholds - Binarisation thresholds to evaluate.
+ * @param[in] hough_thresholds - Hough thresholds to evaluate.
+ * @param[in] ground_truth - Expected classified lines, e.g. from read_csv_results().
+ * @return Score of each pair, ordered by binarisation threshold then hough threshold.
+ */
+std::vector<SweepResult> sweep_thresholds(const Image &image, const std::vector<uint32_t> &binarize_thresholds, const std::vector<double> &hough_thresholds,
+										  const std::vector<ClassifiedLineSegment> &ground_truth)
+{
+	const StratifiedHough stratified(image, binarize_thresholds);
+	const Hough hough;
+	LineClassifier classifier;
+
+	std::vector<SweepResult> results;
+	results.reserve(stratified.get_thresholds().size() * hough_thresholds.size());
+	for (size_t k = 0; k < stratified.get_thresholds().size(); k++)
+	{
+		const uint32_t binarize_threshold = stratified.get_thresholds()[k];
+		const std::vector<std::vector<double>> hough_transform = stratified.create_hough_transform(k);
+		const BinaryImage binary_image(image, binarize_threshold);
+
+		for (const double hough_threshold : hough_thresholds)
+		{
+			const std::vector<Line> hough_lines = hough.get_hough_lines(image, hough_transform, hough_threshold);
+
+			SweepResult result = {binarize_threshold, hough_threshold, hough_lines.size()};
+			score_lines(classifier.classify_lines(image, binary_image, hough_lines), ground_truth, result);
+			results.push_back(result);
+		}
+	}
+	return results;
+}
+
+/**
+ * @brief Prints sweep results as CSV to standard output.
+ * @param[in] results - Results of sweep_thresholds().
+ */
+void print_sweep_results(const std::vector<SweepResult> &results)
+{
+	std::cout << "Binarize,Hough,Hough Lines,Matched,False,Mean Error,\n";
+	for (const SweepResult &result : results)
+		std::cout << result.binarize_threshold << "," << result.hough_threshold << "," << result.hough_line_count << ","
+				  << result.matched_lines << "," << result.false_lines << "," << result.mean_error << ",\n";
+}
@@ -0,0 +1,257 @@
+#include <replay-simulator.h>
+#include <binary-image.h>
+#include <hough.h>
+#include <line-classifier.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+/**
+ * @brief Sums the processed frames of all streams.
+ */
+size_t ReplayReport::frames_processed() const
+{
+	size_t total = 0;
+	for (const StreamReport &stream : streams)
+		total += stream.frames_processed;
+	return total;
+}
+
+/**
+ * @brief Sums the dropped frames of all streams.
+ */
+size_t ReplayReport::frames_dropped() const
+{
+	size_t total = 0;
+	for (const StreamReport &stream : streams)
+		total += stream.frames_dropped;
+	return total;
+}
+
+/**
+ * @brief Prints the report as a table, one row per stream followed by the totals.
+ */
+void ReplayReport::print() const
+{
+	printf("%-8s %8s %9s %7s %9s %9s %8s %8s %8s %8s\n", "Stream", "Offered", "Processed", "Dropped", "Max Queue",
+		   "Avg Queue", "p50 ms", "p95 ms", "p99 ms", "Max ms");
+	for (size_t i = 0; i < streams.size(); i++)
+	{
+		const StreamReport &stream = streams[i];
+		printf("%-8zu %8zu %9zu %7zu %9zu %9.2f %8.2f %8.2f %8.2f %8.2f\n", i, stream.frames_offered, stream.frames_processed,
+			   stream.frames_dropped, stream.max_queue_depth, stream.mean_queue_depth, stream.latency_p50_ms, stream.latency_p95_ms,
+			   stream.latency_p99_ms, stream.latency_max_ms);
+	}
+	printf("Processed %zu frames in %.2f s (%.1f fps), dropped %zu\n", frames_processed(), elapsed_seconds, throughput(), frames_dropped());
+}
+
+/**
+ * @brief Prepares a replay.
+ * @param[in] frames - Frames to replay, each stream cycles through them starting at a different offset.
+ * @param[in] config - Cameras and pipeline to simulate.
+ */
+ReplaySimulator::ReplaySimulator(std::vector<Image> frames, const ReplayConfig &config)
+	: frames(std::move(frames)), config(config)
+{
+}
+
+/**
+ * @brief Runs the replay in real time, blocking for its duration plus the time to drain the queues.
+ * @return Statistics of the replay.
+ */
+ReplayReport ReplaySimulator::run()
+{
+	queues.assign(config.stream_count, {});
+	reports.assign(config.stream_count, {});
+	latencies.assign(config.stream_count, {});
+	queue_depth_totals.assign(config.stream_count, 0);
+	pacers_running = config.stream_count;
+	if (frames.empty())
+		return {reports, 0.0};
+
+	const size_t worker_count = config.worker_count ? config.worker_count : std::max(1u, std::thread::hardware_concurrency());
+	const Clock::time_point start = Clock::now();
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < worker_count; i++)
+		threads.emplace_back(&ReplaySimulator::serve, this);
+	for (size_t stream = 0; stream < config.stream_count; stream++)
+		threads.emplace_back(&ReplaySimulator::pace_stream, this, stream, start);
+	for (std::thread &thread : threads)
+		thread.join();
+
+	ReplayReport report = {reports, std::chrono::duration<double>(Clock::now() - start).count()};
+	for (size_t stream = 0; stream < config.stream_count; stream++)
+	{
+		StreamReport &stream_report = report.streams[stream];
+		std::vector<double> &stream_latencies = latencies[stream];
+		if (stream_report.frames_offered)
+			stream_report.mean_queue_depth = static_cast<double>(queue_depth_totals[stream]) / stream_report.frames_offered;
+		if (stream_latencies.empty())
+			continue;
+
+		const auto percentile = [&](const double p)
+		{
+			const size_t n = std::min(stream_latencies.size() - 1, static_cast<size_t>(p * stream_latencies.size()));
+			std::nth_element(stream_latencies.begin(), stream_latencies.begin() + n, stream_latencies.end());
+			return stream_latencies[n];
+		};
+		stream_report.latency_p50_ms = percentile(0.50);
+		stream_report.latency_p95_ms = percentile(0.95);
+		stream_report.latency_p99_ms = percentile(0.99);
+		stream_report.latency_max_ms = *std::max_element(stream_latencies.begin(), stream_latencies.end());
+	}
+	return report;
+}
+
+/**
+ * @brief Offers frames of a stream at the configured rate, dropping frames whilst its queue is full.
+ * @param[in] stream - Index of the stream.
+ * @param[in] start - Start of the replay, shared by all streams.
+ */
+void ReplaySimulator::pace_stream(const size_t stream, const Clock::time_point start)
+{
+	const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.frames_per_second));
+	const size_t frame_count = static_cast<size_t>(config.duration_seconds * config.frames_per_second);
+
+	for (size_t i = 0; i < frame_count; i++)
+	{
+		const Clock::time_point arrival = start + i * period;
+		std::this_thread::sleep_until(arrival);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		StreamReport &report = reports[stream];
+		std::deque<Job> &queue = queues[stream];
+
+		report.frames_offered++;
+		queue_depth_totals[stream] += queue.size();
+		if (queue.size() >= config.queue_capacity)
+		{
+			report.frames_dropped++;
+			continue;
+		}
+		queue.push_back({(stream + i) % frames.size(), arrival});
+		report.max_queue_depth = std::max(report.max_queue_depth, queue.size());
+		jobs_changed.notify_one();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	pacers_running--;
+	jobs_changed.notify_all();
+}
+
+/**
+ * @brief Worker, processing frames from the stream queues round-robin until every stream has finished and been drained.
+ */
+void ReplaySimulator::serve()
+{
+	Hough hough;
+	LineClassifier classifier;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		size_t stream = queues.size();
+		jobs_changed.wait(lock, [&]
+						  {
+			for (size_t i = 0; i < queues.size(); i++)
+			{
+				const size_t candidate = (next_queue + i) % queues.size();
+				if (!queues[candidate].empty())
+				{
+					stream = candidate;
+					return true;
+				}
+			}
+			return pacers_running == 0; });
+		if (stream == queues.size())
+			return;
+
+		const Job job = queues[stream].front();
+		queues[stream].pop_front();
+		next_queue = (stream + 1) % queues.size();
+
+		lock.unlock();
+		const Image &frame = frames[job.frame_index];
+		const BinaryImage binary_image(frame, config.binarize_threshold);
+		classifier.classify_lines(frame, binary_image, hough.find_lines(frame, binary_image, config.hough_threshold));
+		const double latency = std::chrono::duration<double, std::milli>(Clock::now() - job.arrival).count();
+		lock.lock();
+
+		reports[stream].frames_processed++;
+		latencies[stream].push_back(latency);
+	}
+}
+
+/**
+ * @brief Creates variants of a frame, as seen by a slightly moving camera under changing light, for replay.
+ * @details Variant 0 is the frame itself. Others are shifted by up to 2 columns and 1 row, and brightened or darkened by up to
+ * 12 levels, deterministically so replays are repeatable.
+ * @param[in] image - Frame to create variants of.
+ * @param[in] count - Number of variants, including the frame itself.
+ * @return Variants of the frame.
+ */
+std::vector<Image> make_synthetic_variants(const Image &image, const size_t count)
+{
+	std::vector<Image> variants;
+	variants.reserve(count);
+	for (size_t k = 0; k < count; k++)
+	{
+		if (k == 0)
+		{
+			variants.push_back(image);
+			continue;
+		}
+
+		const int64_t shift_x = static_cast<int64_t>(k % 5) - 2;
+		const int64_t shift_y = static_cast<int64_t>(k / 5 % 3) - 1;
+		const int32_t brightness = static_cast<int32_t>(k * 7 % 25) - 12;
+
+		std::vector<uint8_t> samples(image.samples.size(), 0);
+		for (int64_t row = 0; row < image.height; row++)
+		{
+			const int64_t source_row = row - shift_y;
+			if (source_row < 0 || source_row >= image.height)
+				continue;
+			for (int64_t col = 0; col < image.width; col++)
+			{
+				const int64_t source_col = col - shift_x;
+				if (source_col < 0 || source_col >= image.width)
+					continue;
+				const int32_t sample = image.samples[source_row * image.width + source_col] + brightness;
+				samples[row * image.width + col] = static_cast<uint8_t>(std::clamp(sample, 0, 255));
+			}
+		}
+		variants.emplace_back(samples, image.width, image.height);
+	}
+	return variants;
+}
+
+/**
+ * @brief Loads recorded .raw frames for replay, checking each holds exactly one frame of the given size.
+ * @param[in] paths - Paths of the .raw files, replayed in this order.
+ * @param[in] width - Width of every frame.
+ * @param[in] height - Height of every frame.
+ * @param[out] frames - Loaded frames.
+ * @return Flag indicating if every frame was loaded.
+ */
+bool load_raw_frames(const std::vector<std::string_view> &paths, const uint32_t width, const uint32_t height, std::vector<Image> &frames)
+{
+	frames.clear();
+	frames.reserve(paths.size());
+	for (const std::string_view path : paths)
+	{
+		std::error_code error;
+		const uintmax_t file_size = std::filesystem::file_size(std::filesystem::path(path), error);
+		if (error || file_size != static_cast<uintmax_t>(width) * height)
+		{
+			std::cerr << "Cannot replay " << path << ", expected a " << width << "x" << height << " frame of "
+					  << static_cast<uintmax_t>(width) * height << " bytes\n";
+			return false;
+		}
+		frames.emplace_back(path, width, height);
+	}
+	return true;
+}
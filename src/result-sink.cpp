@@ -0,0 +1,404 @@
+#include <result-sink.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Name of a line class as reported in results.csv.
+ * @note The reported base line is the inner segment, between the singles sidelines.
+ * @param[in] line_class - Class of the line.
+ * @return Name of the line, or an empty view if the class is not reported.
+ */
+static std::string_view reported_line_name(const LineClasses line_class)
+{
+	switch (line_class)
+	{
+	case LineClasses::INNER_BASE_LINE:
+		return "Base Line";
+	case LineClasses::SERVICE_LINE:
+		return "Service Line";
+	case LineClasses::CENTRE_SERVICE_LINE:
+		return "Centre Service Line";
+	case LineClasses::DOUBLES_SIDELINE:
+		return "Doubles Side Line";
+	case LineClasses::SINGLES_SIDELINE:
+		return "Singles Side Line";
+	default:
+		return {};
+	}
+}
+
+/**
+ * @brief Opens a CSV file for results, and writes the header if the file is new.
+ * @param[in] path - Path to the CSV file.
+ * @param[in] include_frame_id - Optional argument to prefix each row with the frame id.
+ * @param[in] append - Optional argument to append to an existing file, rather than truncating it.
+ */
+CsvResultSink::CsvResultSink(const std::string_view path, const bool include_frame_id, const bool append)
+	: include_frame_id(include_frame_id)
+{
+	file = fopen(std::string(path).c_str(), append ? "ab" : "wb");
+	buffer.reserve(BUFFER_CAPACITY);
+
+	// The position of a file opened for appending is unspecified until the first write, so seek to the end to check if it is new.
+	if (file && fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0)
+		buffer += include_frame_id ? "Frame,Line,X,Y,X,Y,\n" : "Line,X,Y,X,Y,\n";
+}
+
+CsvResultSink::~CsvResultSink()
+{
+	flush();
+	if (file)
+		fclose(file);
+}
+
+/**
+ * @brief Formats the reported lines of a frame into the buffer.
+ * @param[in] frame_id - Id of the frame the lines belong to.
+ * @param[in] timestamp - Timestamp of the frame, unused by CSV output.
+ * @param[in] lines - Classified lines of the frame.
+ */
+void CsvResultSink::write(const uint64_t frame_id, [[maybe_unused]] const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines)
+{
+	for (const ClassifiedLineSegment &line : lines)
+	{
+		const std::string_view name = reported_line_name(line.line_class);
+		if (name.empty())
+			continue;
+
+		if (include_frame_id)
+			append_number(static_cast<int64_t>(frame_id));
+		buffer += name;
+		buffer += ',';
+		append_number(line.origin.x);
+		append_number(line.origin.y);
+		append_number(line.destination.x);
+		append_number(line.destination.y);
+		buffer += '\n';
+	}
+
+	if (buffer.size() >= BUFFER_CAPACITY)
+		flush();
+}
+
+/**
+ * @brief Writes the buffered rows to disk.
+ */
+void CsvResultSink::flush()
+{
+	if (file && !buffer.empty())
+	{
+		fwrite(buffer.data(), 1, buffer.size(), file);
+		fflush(file);
+	}
+	buffer.clear();
+}
+
+/**
+ * @brief Appends a number followed by a comma to the buffer, without going through a stream.
+ * @param[in] value - Number to append.
+ */
+void CsvResultSink::append_number(const int64_t value)
+{
+	char digits[24];
+	const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+	buffer.append(digits, result.ptr);
+	buffer += ',';
+}
+
+/**
+ * @brief Creates a new binary log, truncating any existing file.
+ * @param[in] path - Path to the binary log.
+ */
+BinaryLogResultSink::BinaryLogResultSink(const std::string_view path) : path(path)
+{
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(this->path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		report_failure("could not be created");
+		return;
+	}
+	file_handle = reinterpret_cast<intptr_t>(handle);
+#else
+	file_handle = open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file_handle < 0)
+	{
+		report_failure("could not be created");
+		return;
+	}
+#endif
+
+	map(INITIAL_FILE_SIZE);
+	if (!mapped)
+	{
+		// Without a header the file is not a valid log, so remove it rather than leave it behind.
+		report_failure("could not be mapped");
+#ifdef _WIN32
+		CloseHandle(reinterpret_cast<HANDLE>(file_handle));
+#else
+		close(static_cast<int>(file_handle));
+#endif
+		file_handle = -1;
+		std::remove(this->path.c_str());
+		return;
+	}
+
+	BinaryLogHeader &h = header();
+	std::memcpy(h.magic, BinaryLogHeader::MAGIC, sizeof(h.magic));
+	h.version = BinaryLogHeader::VERSION;
+	h.record_size = sizeof(BinaryLogRecord);
+	h.record_count = 0;
+	h.reserved = 0;
+}
+
+/**
+ * @brief Flushes the log and truncates the file to the used length.
+ */
+BinaryLogResultSink::~BinaryLogResultSink()
+{
+	if (file_handle < 0)
+		return;
+
+	flush();
+	unmap();
+
+	const size_t used_size = sizeof(BinaryLogHeader) + record_count * sizeof(BinaryLogRecord);
+#ifdef _WIN32
+	HANDLE handle = reinterpret_cast<HANDLE>(file_handle);
+	LARGE_INTEGER offset;
+	offset.QuadPart = static_cast<LONGLONG>(used_size);
+	SetFilePointerEx(handle, offset, nullptr, FILE_BEGIN);
+	SetEndOfFile(handle);
+	CloseHandle(handle);
+#else
+	ftruncate(static_cast<int>(file_handle), static_cast<off_t>(used_size));
+	close(static_cast<int>(file_handle));
+#endif
+}
+
+/**
+ * @brief Appends a record per classified line, growing the mapped file if required.
+ * @param[in] frame_id - Id of the frame the lines belong to.
+ * @param[in] timestamp - Timestamp of the frame.
+ * @param[in] lines - Classified lines of the frame.
+ */
+void BinaryLogResultSink::write(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines)
+{
+	if (!mapped)
+		return;
+
+	const size_t required_size = sizeof(BinaryLogHeader) + (record_count + lines.size()) * sizeof(BinaryLogRecord);
+	if (required_size > mapped_size)
+	{
+		size_t new_size = mapped_size * 2;
+		while (new_size < required_size)
+			new_size *= 2;
+		map(new_size);
+		if (!mapped)
+		{
+			// Records written so far remain in the file, as the record count is published before remapping.
+			report_failure("could not grow to " + std::to_string(new_size) + " bytes, records from frame " + std::to_string(frame_id) + " on are dropped");
+			return;
+		}
+	}
+
+	BinaryLogRecord *records = reinterpret_cast<BinaryLogRecord *>(mapped + sizeof(BinaryLogHeader));
+	for (const ClassifiedLineSegment &line : lines)
+	{
+		records[record_count++] = {frame_id, timestamp, static_cast<int32_t>(line.line_class),
+								   static_cast<int32_t>(line.origin.x), static_cast<int32_t>(line.origin.y),
+								   static_cast<int32_t>(line.destination.x), static_cast<int32_t>(line.destination.y), 0};
+	}
+}
+
+/**
+ * @brief Publishes the record count to the header, so readers see all records written so far.
+ */
+void BinaryLogResultSink::flush()
+{
+	if (mapped)
+		header().record_count = record_count;
+}
+
+/**
+ * @brief Marks the log as failed, and reports why on standard error.
+ * @param[in] reason - Description of the failure.
+ */
+void BinaryLogResultSink::report_failure(const std::string &reason)
+{
+	failed = true;
+	std::cerr << "Binary result log " << path << " " << reason << "\n";
+}
+
+/**
+ * @brief Resizes the file and maps all of it into memory, replacing any previous mapping.
+ * @param[in] size - Size of the file, in bytes.
+ */
+void BinaryLogResultSink::map(const size_t size)
+{
+	if (mapped)
+		header().record_count = record_count;
+	unmap();
+
+#ifdef _WIN32
+	HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(file_handle), nullptr, PAGE_READWRITE,
+										static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+	if (!mapping)
+		return;
+	void *view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+	if (!view)
+	{
+		CloseHandle(mapping);
+		return;
+	}
+	mapping_handle = reinterpret_cast<intptr_t>(mapping);
+#else
+	if (ftruncate(static_cast<int>(file_handle), static_cast<off_t>(size)) != 0)
+		return;
+	void *view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(file_handle), 0);
+	if (view == MAP_FAILED)
+		return;
+#endif
+
+	mapped = static_cast<uint8_t *>(view);
+	mapped_size = size;
+}
+
+/**
+ * @brief Releases the current mapping, if any.
+ */
+void BinaryLogResultSink::unmap()
+{
+	if (!mapped)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mapped);
+	CloseHandle(reinterpret_cast<HANDLE>(mapping_handle));
+	mapping_handle = 0;
+#else
+	munmap(mapped, mapped_size);
+#endif
+	mapped = nullptr;
+	mapped_size = 0;
+}
+
+/**
+ * @brief Opens a binary log and validates its header.
+ * @param[in] path - Path to the binary log.
+ */
+BinaryLogReader::BinaryLogReader(const std::string_view path)
+{
+	file = fopen(std::string(path).c_str(), "rb");
+	if (!file)
+		return;
+
+	valid = fread(&header, sizeof(header), 1, file) == 1 &&
+			std::memcmp(header.magic, BinaryLogHeader::MAGIC, sizeof(header.magic)) == 0 &&
+			header.version == BinaryLogHeader::VERSION &&
+			header.record_size == sizeof(BinaryLogRecord);
+}
+
+BinaryLogReader::~BinaryLogReader()
+{
+	if (file)
+		fclose(file);
+}
+
+/**
+ * @brief Reads the next record of the log.
+ * @param[out] record - The record read.
+ * @return Flag indicating if a record was read (false once all records have been read).
+ */
+bool BinaryLogReader::next(BinaryLogRecord &record)
+{
+	if (!valid || records_read >= header.record_count)
+		return false;
+	if (fread(&record, sizeof(record), 1, file) != 1)
+		return false;
+	records_read++;
+	return true;
+}
+
+/**
+ * @brief Prints a binary log as CSV to standard output.
+ * @param[in] path - Path to the binary log.
+ * @return Process exit code.
+ */
+int print_binary_log(const std::string_view path)
+{
+	BinaryLogReader reader(path);
+	if (!reader.is_valid())
+	{
+		std::cerr << "Not a valid binary result log: " << path << "\n";
+		return 1;
+	}
+
+	std::cout << "Frame,Timestamp,Class,X,Y,X,Y,\n";
+	BinaryLogRecord record;
+	while (reader.next(record))
+	{
+		const std::string_view name = reported_line_name(static_cast<LineClasses>(record.line_class));
+		std::cout << record.frame_id << "," << record.timestamp << ",";
+		if (name.empty())
+			std::cout << record.line_class << ",";
+		else
+			std::cout << name << ",";
+		std::cout << record.origin_x << "," << record.origin_y << ","
+				  << record.destination_x << "," << record.destination_y << ",\n";
+	}
+	return 0;
+}
+
+/**
+ * @brief Reads the reported lines of a single frame CSV, as written by CsvResultSink, e.g. as ground truth.
+ * @param[in] path - Path to the CSV file.
+ * @return Classified lines, using the classes the classifier produces. Empty if the file could not be read.
+ */
+std::vector<ClassifiedLineSegment> read_csv_results(const std::string_view path)
+{
+	constexpr LineClasses reported_classes[] = {LineClasses::INNER_BASE_LINE, LineClasses::SERVICE_LINE, LineClasses::CENTRE_SERVICE_LINE,
+												LineClasses::DOUBLES_SIDELINE, LineClasses::SINGLES_SIDELINE};
+
+	std::vector<ClassifiedLineSegment> lines;
+	std::ifstream file{std::string(path)};
+	std::string row;
+	while (std::getline(file, row))
+	{
+		const size_t name_end = row.find(',');
+		if (name_end == std::string::npos)
+			continue;
+
+		const std::string_view name = std::string_view(row).substr(0, name_end);
+		const LineClasses *line_class = std::find_if(std::begin(reported_classes), std::end(reported_classes),
+													 [name](const LineClasses c)
+													 { return reported_line_name(c) == name; });
+		int64_t values[4];
+		const char *begin = row.data() + name_end + 1, *end = row.data() + row.size();
+		size_t value_count = 0;
+		for (; value_count < 4; value_count++)
+		{
+			const std::from_chars_result result = std::from_chars(begin, end, values[value_count]);
+			if (result.ec != std::errc() || result.ptr == end || *result.ptr != ',')
+				break;
+			begin = result.ptr + 1;
+		}
+		if (line_class == std::end(reported_classes) || value_count != 4)
+			continue;
+
+		lines.emplace_back(*line_class, Coordinate::Cartesian(values[0], values[1]), Coordinate::Cartesian(values[2], values[3]));
+	}
+	return lines;
+}
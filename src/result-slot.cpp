@@ -0,0 +1,73 @@
+#include <result-slot.h>
+#include <algorithm>
+
+/**
+ * @brief Publishes a classification, without waiting for readers.
+ * @param[in] frame_id - Id of the classified frame.
+ * @param[in] timestamp - Timestamp of the classified frame.
+ * @param[in] lines - Classified lines, of which the first MAX_LINES are published.
+ * @return Flag indicating if all lines fit in the slot.
+ */
+bool LatestResultSlot::publish(const uint64_t frame_id, const int64_t timestamp, const std::vector<ClassifiedLineSegment> &lines)
+{
+	const uint64_t sequence = published.load(std::memory_order_relaxed) + 1;
+	Buffer &buffer = buffers[sequence % BUFFER_COUNT];
+	const size_t line_count = std::min(lines.size(), MAX_LINES);
+
+	buffer.version.store(2 * sequence - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	buffer.frame_id.store(frame_id, std::memory_order_relaxed);
+	buffer.timestamp.store(timestamp, std::memory_order_relaxed);
+	buffer.line_count.store(static_cast<uint32_t>(line_count), std::memory_order_relaxed);
+	for (size_t i = 0; i < line_count; i++)
+	{
+		std::atomic<int64_t> *values = buffer.values + i * VALUES_PER_LINE;
+		values[0].store(static_cast<int64_t>(lines[i].line_class), std::memory_order_relaxed);
+		values[1].store(lines[i].origin.x, std::memory_order_relaxed);
+		values[2].store(lines[i].origin.y, std::memory_order_relaxed);
+		values[3].store(lines[i].destination.x, std::memory_order_relaxed);
+		values[4].store(lines[i].destination.y, std::memory_order_relaxed);
+	}
+
+	buffer.version.store(2 * sequence, std::memory_order_release);
+	published.store(sequence, std::memory_order_release);
+	return line_count == lines.size();
+}
+
+/**
+ * @brief Copies the latest published classification.
+ * @param[out] snapshot - Copy of the classification, its lines' capacity is reused between reads.
+ * @return Flag indicating if a classification has been published.
+ */
+bool LatestResultSlot::read(Snapshot &snapshot) const
+{
+	while (true)
+	{
+		const uint64_t sequence = published.load(std::memory_order_acquire);
+		if (sequence == 0)
+			return false;
+
+		const Buffer &buffer = buffers[sequence % BUFFER_COUNT];
+		const uint64_t version = buffer.version.load(std::memory_order_acquire);
+		if (version != 2 * sequence)
+			continue; // Lapped by the writer, which has since published newer buffers.
+
+		snapshot.sequence = sequence;
+		snapshot.frame_id = buffer.frame_id.load(std::memory_order_relaxed);
+		snapshot.timestamp = buffer.timestamp.load(std::memory_order_relaxed);
+		const size_t line_count = std::min<size_t>(buffer.line_count.load(std::memory_order_relaxed), MAX_LINES);
+		snapshot.lines.clear();
+		for (size_t i = 0; i < line_count; i++)
+		{
+			const std::atomic<int64_t> *values = buffer.values + i * VALUES_PER_LINE;
+			snapshot.lines.emplace_back(static_cast<LineClasses>(values[0].load(std::memory_order_relaxed)),
+										Coordinate::Cartesian(values[1].load(std::memory_order_relaxed), values[2].load(std::memory_order_relaxed)),
+										Coordinate::Cartesian(values[3].load(std::memory_order_relaxed), values[4].load(std::memory_order_relaxed)));
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (buffer.version.load(std::memory_order_relaxed) == version)
+			return true;
+	}
+}
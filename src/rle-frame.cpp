@@ -0,0 +1,161 @@
+#include <rle-frame.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief Run-length encodes the samples of an image.
+ * @details Samples at or below the floor are encoded as 0, so the background of court footage collapses into long runs. Decoding
+ * remains exact for any threshold at or above the floor.
+ * @param[in] image - Image to encode.
+ * @param[in] floor - Optional argument, samples at or below the floor are encoded as 0.
+ * @return Runs as (count, value) byte pairs, without a header.
+ */
+std::vector<uint8_t> rle_encode(const Image &image, const uint8_t floor)
+{
+	const auto encoded = [floor](const uint8_t sample) -> uint8_t
+	{ return sample > floor ? sample : 0; };
+
+	std::vector<uint8_t> runs;
+	const std::vector<uint8_t> &samples = image.samples;
+	for (size_t i = 0; i < samples.size();)
+	{
+		const uint8_t value = encoded(samples[i]);
+		size_t count = 1;
+		while (count < 255 && i + count < samples.size() && encoded(samples[i + count]) == value)
+			count++;
+
+		runs.push_back(static_cast<uint8_t>(count));
+		runs.push_back(value);
+		i += count;
+	}
+	return runs;
+}
+
+/**
+ * @brief Writes an image as a run-length encoded frame.
+ * @param[in] path - Path of the frame file.
+ * @param[in] image - Image to encode.
+ * @param[in] floor - Optional argument, samples at or below the floor are encoded as 0.
+ * @return Flag indicating if the frame was written.
+ */
+bool write_rle_frame(const std::string_view path, const Image &image, const uint8_t floor)
+{
+	const std::vector<uint8_t> runs = rle_encode(image, floor);
+
+	RleFrameHeader header = {};
+	memcpy(header.magic, RleFrameHeader::MAGIC, sizeof(header.magic));
+	header.version = RleFrameHeader::VERSION;
+	header.width = image.width;
+	header.height = image.height;
+	header.floor = floor;
+	header.payload_size = runs.size();
+
+	FILE *fp = fopen(std::string(path).c_str(), "wb");
+	if (!fp)
+		return false;
+	const bool written = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(runs.data(), runs.size(), 1, fp) == 1;
+	fclose(fp);
+	return written;
+}
+
+/**
+ * @brief Decodes runs straight into a binary image, thresholding each run once rather than each sample.
+ * @details Runs at or below the threshold are skipped, and runs above it are set a word at a time, so the 8-bit image is never
+ * materialised.
+ * @param[in] runs - Runs as (count, value) byte pairs.
+ * @param[in] size - Size of the runs in bytes.
+ * @param[in] floor - Floor the runs were encoded with, see RleFrameHeader::floor.
+ * @param[in,out] binary_image - Cleared binary image of the frame's size, which valid samples are set in.
+ * @param[in] threshold - Samples greater than the threshold are valid, at least the floor.
+ * @return Flag indicating if the runs covered the frame exactly, and the threshold was not below the floor.
+ */
+bool rle_decode_binary(const uint8_t *runs, const size_t size, const uint32_t floor, BinaryImage &binary_image, const uint32_t threshold)
+{
+	if (threshold < floor || size % 2 != 0)
+		return false;
+
+	const size_t sample_count = static_cast<size_t>(binary_image.width) * binary_image.height;
+	size_t index = 0;
+	for (size_t i = 0; i < size; i += 2)
+	{
+		const size_t count = runs[i];
+		if (index + count > sample_count)
+			return false;
+		if (runs[i + 1] > threshold)
+			binary_image.set_range(index, index + count);
+		index += count;
+	}
+	return index == sample_count;
+}
+
+/**
+ * @brief Decodes runs straight into the coordinates of valid samples, in the order of Image::samples.
+ * @see Hough::create_hough_transform() for the coordinate convention.
+ * @param[in] runs - Runs as (count, value) byte pairs.
+ * @param[in] size - Size of the runs in bytes.
+ * @param[in] floor - Floor the runs were encoded with, see RleFrameHeader::floor.
+ * @param[in] width - Width of the frame.
+ * @param[in] height - Height of the frame.
+ * @param[in] threshold - Samples greater than the threshold are valid, at least the floor.
+ * @param[out] coordinates - Coordinates of valid samples.
+ * @return Flag indicating if the runs covered the frame exactly, and the threshold was not below the floor.
+ */
+bool rle_decode_coordinates(const uint8_t *runs, const size_t size, const uint32_t floor, const uint32_t width, const uint32_t height,
+							const uint32_t threshold, std::vector<Coordinate::Cartesian> &coordinates)
+{
+	coordinates.clear();
+	if (threshold < floor || size % 2 != 0)
+		return false;
+
+	const size_t sample_count = static_cast<size_t>(width) * height;
+	size_t index = 0;
+	for (size_t i = 0; i < size; i += 2)
+	{
+		const size_t end = index + runs[i];
+		if (end > sample_count)
+			return false;
+		if (runs[i + 1] > threshold)
+			for (size_t j = index; j < end; j++)
+				coordinates.push_back(Coordinate::Cartesian(j / width, j % width));
+		index = end;
+	}
+	return index == sample_count;
+}
+
+/**
+ * @brief Reads the runs of a run-length encoded frame, without decoding them.
+ * @param[in] path - Path of the frame file.
+ * @param[out] runs - Runs as (count, value) byte pairs.
+ * @param[out] width - Width of the frame.
+ * @param[out] height - Height of the frame.
+ * @param[out] floor - Floor the runs were encoded with, the lowest threshold they may be decoded at.
+ * @return Flag indicating if the frame was read, which requires the payload to fill the rest of the file exactly.
+ */
+bool read_rle_frame(const std::string_view path, std::vector<uint8_t> &runs, uint32_t &width, uint32_t &height, uint32_t &floor)
+{
+	std::error_code error;
+	const uintmax_t file_size = std::filesystem::file_size(std::filesystem::path(path), error);
+	if (error)
+		return false;
+
+	FILE *fp = fopen(std::string(path).c_str(), "rb");
+	if (!fp)
+		return false;
+
+	RleFrameHeader header;
+	bool valid = fread(&header, sizeof(header), 1, fp) == 1 && memcmp(header.magic, RleFrameHeader::MAGIC, sizeof(header.magic)) == 0 &&
+				 header.version == RleFrameHeader::VERSION && header.payload_size == file_size - sizeof(header) && header.floor <= 255;
+	if (valid)
+	{
+		runs.resize(header.payload_size);
+		valid = runs.empty() || fread(runs.data(), runs.size(), 1, fp) == 1;
+		width = header.width;
+		height = header.height;
+		floor = header.floor;
+	}
+	fclose(fp);
+	return valid;
+}
@@ -0,0 +1,527 @@
+#include <self-check.h>
+#include <binary-image.h>
+#include <court-model.h>
+#include <debug-renderer.h>
+#include <frame-gate.h>
+#include <hough.h>
+#include <replay-simulator.h>
+#include <result-sink.h>
+#include <result-slot.h>
+#include <rle-frame.h>
+#include <streaming-hough.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Named check of an invariant of the pipeline, run against the sample frame.
+ */
+struct SelfCheck
+{
+	std::string_view name;
+	bool (*run)(const Image &image, const uint32_t binarize_threshold);
+};
+
+/**
+ * @brief Binarises an image as main() does, valid samples becoming 255.
+ */
+static Image binarized(Image image, const uint32_t binarize_threshold)
+{
+	for (uint8_t &sample : image.samples)
+		sample = (sample > binarize_threshold) ? 255 : 0;
+	return image;
+}
+
+/**
+ * @brief Lines of a frame in the binary log check, derived from its frame id.
+ */
+static std::vector<ClassifiedLineSegment> log_lines(const uint64_t frame_id)
+{
+	std::vector<ClassifiedLineSegment> lines;
+	const int64_t id = static_cast<int64_t>(frame_id);
+	for (int64_t i = 0; i < 4; i++)
+		lines.emplace_back(static_cast<LineClasses>((frame_id + i) % 6), Coordinate::Cartesian(id, i), Coordinate::Cartesian(i, -id));
+	return lines;
+}
+
+/**
+ * @brief Writes frames to a BinaryLogResultSink and checks that BinaryLogReader reads back every record of them, in order.
+ * @param[in] path - Path of the log.
+ * @param[in] first_frame - Id of the first frame.
+ * @param[in] frame_count - Number of frames to write, each of 4 lines.
+ * @return Flag indicating if the log was read back identically.
+ */
+static bool round_trip_binary_log(const std::string &path, const uint64_t first_frame, const uint64_t frame_count)
+{
+	{
+		BinaryLogResultSink sink(path);
+		for (uint64_t frame_id = first_frame; frame_id < first_frame + frame_count; frame_id++)
+			sink.write(frame_id, -static_cast<int64_t>(frame_id), log_lines(frame_id));
+		if (!sink.is_valid())
+			return false;
+
+		// Flushed records are visible to readers whilst the log is still open.
+		sink.flush();
+		BinaryLogReader reader(path);
+		if (!reader.is_valid() || reader.size() != frame_count * 4)
+			return false;
+	}
+
+	BinaryLogReader reader(path);
+	if (!reader.is_valid() || reader.size() != frame_count * 4)
+		return false;
+	BinaryLogRecord record;
+	for (uint64_t frame_id = first_frame; frame_id < first_frame + frame_count; frame_id++)
+		for (const ClassifiedLineSegment &line : log_lines(frame_id))
+			if (!reader.next(record) || record.frame_id != frame_id || record.timestamp != -static_cast<int64_t>(frame_id) ||
+				record.line_class != static_cast<int32_t>(line.line_class) || record.origin_x != line.origin.x || record.origin_y != line.origin.y ||
+				record.destination_x != line.destination.x || record.destination_y != line.destination.y)
+				return false;
+	return !reader.next(record) && std::filesystem::file_size(path) == sizeof(BinaryLogHeader) + frame_count * 4 * sizeof(BinaryLogRecord);
+}
+
+/**
+ * @brief Checks that a binary result log reads back identically, after growing its mapping several times, and after reopening an
+ * existing log, which replaces its records.
+ */
+static bool check_binary_log(const Image &, const uint32_t)
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "line-classification-check.lclog").string();
+
+	// 60000 records of 40 bytes need 2 growths of the initial 1 MiB mapping.
+	const bool grown = round_trip_binary_log(path, 0, 15000);
+	const bool reopened = grown && round_trip_binary_log(path, 20000, 100);
+	std::filesystem::remove(path);
+
+	if (!grown || !reopened)
+	{
+		printf("  %s log: records differ when read back\n", grown ? "reopened" : "grown");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks the bit-packed BinaryImage against the byte image it replaced, at the default and a sparser threshold: packing,
+ * set sample coordinates, range scans and ROI checks must all match scans of the binarised samples.
+ */
+static bool check_binary_image(const Image &image, const uint32_t binarize_threshold)
+{
+	for (const uint32_t threshold : {binarize_threshold, binarize_threshold + 70})
+	{
+		const Image binary = binarized(image, threshold);
+		const BinaryImage binary_image(image, threshold);
+		if (binary_image.words != BinaryImage(binary).words)
+		{
+			printf("  threshold %u: packing the 8-bit and binarised frames differ\n", threshold);
+			return false;
+		}
+
+		std::vector<Coordinate::Cartesian> expected_coordinates;
+		for (size_t i = 0; i < binary.samples.size(); i++)
+			if (binary.samples[i] != 0)
+				expected_coordinates.push_back(binary.index_to_coordinate(static_cast<int32_t>(i)));
+		const std::vector<Coordinate::Cartesian> coordinates = binary_image.find_set_coordinates();
+		bool identical = coordinates.size() == expected_coordinates.size() && binary_image.count() == expected_coordinates.size();
+		for (size_t i = 0; identical && i < coordinates.size(); i++)
+			identical = coordinates[i].x == expected_coordinates[i].x && coordinates[i].y == expected_coordinates[i].y;
+		if (!identical)
+		{
+			printf("  threshold %u: set coordinates or count differ from the binarised frame\n", threshold);
+			return false;
+		}
+
+		// Ranges from empty to several rows long, at deterministic pseudo-random offsets.
+		uint64_t state = 1;
+		const size_t sample_count = binary.samples.size();
+		for (size_t k = 0; k < 4096; k++)
+		{
+			state = state * 6364136223846793005 + 1442695040888963407;
+			const size_t begin = (state >> 33) % sample_count;
+			const size_t end = std::min(sample_count, begin + (state >> 17) % (4 * static_cast<size_t>(image.width)) * (k % 4) / 3);
+			const bool expected = std::any_of(binary.samples.begin() + begin, binary.samples.begin() + end, [](const uint8_t sample)
+											  { return sample != 0; });
+			if (binary_image.any_in_range(begin, end) != expected)
+			{
+				printf("  threshold %u: any_in_range(%zu, %zu) differs from the binarised frame\n", threshold, begin, end);
+				return false;
+			}
+		}
+
+		// ROIs across the frame, including its edges, of the sizes used by the classifier and larger.
+		for (int32_t index = 0; index < static_cast<int32_t>(sample_count); index += 997)
+			for (const auto &[horz_size, vert_size] : {std::pair<int32_t, int32_t>(1, 1), {5, 3}, {40, 10}, {100, 100}})
+				if (binary_image.does_block_contain_samples(index, horz_size, vert_size) != binary.does_block_contain_samples(index, horz_size, vert_size))
+				{
+					printf("  threshold %u: %dx%d ROI at %d differs from the binarised frame\n", threshold, horz_size, vert_size, index);
+					return false;
+				}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that CourtTracker verifies its court model in the frame it was fitted to, and rejects an overexposed frame, and that
+ * the court model is fitted with the base line left to right in the image.
+ */
+static bool check_court_tracker(const Image &image, const uint32_t binarize_threshold)
+{
+	const Image binary = binarized(image, binarize_threshold);
+	const BinaryImage binary_image(binary);
+	CourtTracker tracker;
+
+	const std::vector<ClassifiedLineSegment> lines = tracker.classify(binary, binary_image);
+	const size_t line_count = lines.size();
+	const size_t reused_count = tracker.classify(binary, binary_image).size();
+	if (tracker.classified_frames != 1 || tracker.verified_frames != 1 || reused_count != line_count)
+	{
+		printf("  same frame: %zu classified, %zu verified, expected 1 of each\n", tracker.classified_frames, tracker.verified_frames);
+		return false;
+	}
+
+	const Image white(std::vector<uint8_t>(image.samples.size(), 255), image.width, image.height);
+	tracker.classify(white, BinaryImage(white));
+	if (tracker.verified_frames != 1)
+	{
+		printf("  white frame: verified against the court model\n");
+		return false;
+	}
+
+	// The base line's singles corners (at -4.115 and 4.115 m) must project left to right in the image, whichever way round the
+	// endpoints of the classified lines are.
+	for (const bool reversed : {false, true})
+	{
+		std::vector<ClassifiedLineSegment> fit_lines;
+		for (const ClassifiedLineSegment &line : lines)
+			fit_lines.emplace_back(line.line_class, reversed ? line.destination : line.origin, reversed ? line.origin : line.destination);
+
+		CourtModel model;
+		double left_x, left_y, right_x, right_y;
+		if (!model.fit(fit_lines) || !model.project(-4.115, 0.0, left_x, left_y) || !model.project(4.115, 0.0, right_x, right_y) ||
+			left_x >= right_x)
+		{
+			printf("  %s lines: base line corners not fitted left to right\n", reversed ? "reversed" : "classified");
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that the batch transform gives the same transforms and vote histograms as transforming each frame alone, over
+ * more frames than share one accumulator.
+ */
+static bool check_hough_batch(const Image &image, const uint32_t binarize_threshold)
+{
+	std::vector<BinaryImage> binary_images;
+	for (const Image &variant : make_synthetic_variants(image, 11))
+		binary_images.emplace_back(variant, binarize_threshold);
+
+	Hough hough;
+	std::vector<std::vector<uint32_t>> vote_histograms;
+	const std::vector<std::vector<std::vector<double>>> batch = hough.create_hough_transforms(binary_images, &vote_histograms);
+
+	if (batch.size() != binary_images.size() || vote_histograms.size() != binary_images.size())
+	{
+		printf("  %zu transforms for %zu frames\n", batch.size(), binary_images.size());
+		return false;
+	}
+	for (size_t k = 0; k < binary_images.size(); k++)
+	{
+		if (batch[k] != hough.create_hough_transform(binary_images[k]) || vote_histograms[k] != hough.get_vote_histogram())
+		{
+			printf("  frame %zu: batch transform differs from the single frame transform\n", k);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that pushing a frame in stripes gives the same binary image, transform and vote histogram as transforming the
+ * whole frame, for stripes of a row, of a size not dividing the height, and larger than the frame.
+ */
+static bool check_streaming_hough(const Image &image, const uint32_t binarize_threshold)
+{
+	const BinaryImage binary_image(image, binarize_threshold);
+	Hough hough;
+	const std::vector<std::vector<double>> hough_transform = hough.create_hough_transform(binary_image);
+
+	for (const uint32_t stripe_rows : {1u, 37u, image.height + 1})
+	{
+		StreamingHough streaming(image.width, image.height, binarize_threshold);
+		// The last stripe may be short, which push_rows() clamps to the frame.
+		for (uint32_t row = 0; row < image.height; row += stripe_rows)
+			streaming.push_rows(image.samples.data() + static_cast<size_t>(row) * image.width, stripe_rows);
+
+		if (!streaming.is_complete() || streaming.get_binary_image().words != binary_image.words || streaming.finish() != hough_transform ||
+			streaming.get_vote_histogram() != hough.get_vote_histogram())
+		{
+			printf("  stripes of %u rows: differs from the whole frame transform\n", stripe_rows);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that decoding the run-length encoded frame gives the same valid samples as binarising the frame, above and at the
+ * encode floor, and that truncated runs and thresholds below the floor are rejected.
+ */
+static bool check_rle_decode(const Image &image, const uint32_t binarize_threshold)
+{
+	for (const uint8_t floor : {uint8_t(0), static_cast<uint8_t>(binarize_threshold)})
+	{
+		const std::vector<uint8_t> runs = rle_encode(image, floor);
+		for (const uint32_t threshold : {static_cast<uint32_t>(floor), binarize_threshold + 20})
+		{
+			const BinaryImage expected(image, threshold);
+			BinaryImage binary_image(image.width, image.height);
+			std::vector<Coordinate::Cartesian> coordinates;
+			if (!rle_decode_binary(runs.data(), runs.size(), floor, binary_image, threshold) || binary_image.words != expected.words ||
+				!rle_decode_coordinates(runs.data(), runs.size(), floor, image.width, image.height, threshold, coordinates))
+			{
+				printf("  floor %u, threshold %u: decoded binary image differs from the binarised frame\n", floor, threshold);
+				return false;
+			}
+
+			const std::vector<Coordinate::Cartesian> expected_coordinates = expected.find_set_coordinates();
+			bool identical = coordinates.size() == expected_coordinates.size();
+			for (size_t i = 0; identical && i < coordinates.size(); i++)
+				identical = coordinates[i].x == expected_coordinates[i].x && coordinates[i].y == expected_coordinates[i].y;
+			if (!identical)
+			{
+				printf("  floor %u, threshold %u: decoded coordinates differ from the binarised frame\n", floor, threshold);
+				return false;
+			}
+		}
+
+		BinaryImage binary_image(image.width, image.height);
+		if (rle_decode_binary(runs.data(), runs.size() - 2, floor, binary_image, binarize_threshold + 20) ||
+			(floor > 0 && rle_decode_binary(runs.data(), runs.size(), floor, binary_image, floor - 1u)))
+		{
+			printf("  floor %u: truncated runs or a threshold below the floor were decoded\n", floor);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Lines of a publication in the result slot stress check, all derived from its frame id so a torn copy is detectable.
+ */
+static std::vector<ClassifiedLineSegment> stress_lines(const uint64_t frame_id)
+{
+	std::vector<ClassifiedLineSegment> lines;
+	const int64_t id = static_cast<int64_t>(frame_id);
+	for (size_t i = 0; i <= frame_id % LatestResultSlot::MAX_LINES; i++)
+		lines.emplace_back(static_cast<LineClasses>((frame_id + i) % 6), Coordinate::Cartesian(id, static_cast<int64_t>(i)), Coordinate::Cartesian(-id, id + static_cast<int64_t>(i)));
+	return lines;
+}
+
+/**
+ * @brief Checks that readers of a LatestResultSlot only ever copy whole publications, in order, whilst one writer publishes as fast
+ * as it can.
+ */
+static bool check_result_slot(const Image &, const uint32_t)
+{
+	constexpr uint64_t PUBLICATIONS = 200000;
+	constexpr size_t READERS = 4;
+
+	LatestResultSlot slot;
+	std::atomic<size_t> torn_reads = 0, reordered_reads = 0;
+	std::vector<std::thread> readers;
+	for (size_t k = 0; k < READERS; k++)
+	{
+		readers.emplace_back([&]
+							 {
+			LatestResultSlot::Snapshot snapshot;
+			uint64_t last_sequence = 0;
+			while (last_sequence < PUBLICATIONS)
+			{
+				if (!slot.read(snapshot))
+					continue;
+				if (snapshot.sequence < last_sequence)
+					reordered_reads++;
+				last_sequence = snapshot.sequence;
+
+				const std::vector<ClassifiedLineSegment> expected = stress_lines(snapshot.frame_id);
+				bool whole = snapshot.frame_id == snapshot.sequence && snapshot.timestamp == -static_cast<int64_t>(snapshot.frame_id) &&
+							 snapshot.lines.size() == expected.size();
+				for (size_t i = 0; whole && i < expected.size(); i++)
+					whole = snapshot.lines[i].line_class == expected[i].line_class && snapshot.lines[i].origin.x == expected[i].origin.x &&
+							snapshot.lines[i].origin.y == expected[i].origin.y && snapshot.lines[i].destination.x == expected[i].destination.x &&
+							snapshot.lines[i].destination.y == expected[i].destination.y;
+				if (!whole)
+					torn_reads++;
+			} });
+	}
+
+	for (uint64_t frame_id = 1; frame_id <= PUBLICATIONS; frame_id++)
+		slot.publish(frame_id, -static_cast<int64_t>(frame_id), stress_lines(frame_id));
+	for (std::thread &reader : readers)
+		reader.join();
+
+	if (torn_reads || reordered_reads)
+	{
+		printf("  %zu torn and %zu out of order reads\n", torn_reads.load(), reordered_reads.load());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks FrameGate's hits and misses on repeated, noisy and changed frames and on a change of binarisation threshold, with the
+ * default and a zero tolerance, and that its classification matches the ungated pipeline.
+ */
+static bool check_frame_gate(const Image &image, const uint32_t binarize_threshold)
+{
+	const Image binary = binarized(image, binarize_threshold);
+	const BinaryImage binary_image(binary);
+	Hough hough;
+	LineClassifier classifier;
+	const size_t line_count = classifier.classify_lines(binary, binary_image, hough.find_lines(binary, binary_image)).size();
+
+	Image noisy = image;
+	for (size_t i = 0; i < noisy.samples.size(); i += 97)
+		noisy.samples[i] ^= 1;
+	const Image shifted = make_synthetic_variants(image, 2).back();
+
+	// Frames in order with their binarisation threshold, and whether each should reuse the last processed frame's classification.
+	const uint32_t other_threshold = binarize_threshold + 40;
+	const std::vector<std::tuple<const Image *, uint32_t, bool>> frames = {
+		{&image, binarize_threshold, false}, {&image, binarize_threshold, true}, {&noisy, binarize_threshold, true},
+		{&shifted, binarize_threshold, false}, {&image, binarize_threshold, false}, {&image, other_threshold, false}};
+	for (const uint32_t stride : {0u, 8u})
+	{
+		FrameGate gate(1.0, stride);
+		size_t expected_hits = 0;
+		for (const auto &[frame, threshold, hit] : frames)
+		{
+			const size_t lines = gate.classify(*frame, threshold).size();
+			expected_hits += hit ? 1 : 0;
+			if (gate.hits != expected_hits || (frame == &image && threshold == binarize_threshold && lines != line_count))
+			{
+				printf("  stride %u: %zu hits and %zu misses, expected %zu hits\n", stride, gate.hits, gate.misses, expected_hits);
+				return false;
+			}
+		}
+	}
+
+	FrameGate exact(0.0);
+	exact.classify(image, binarize_threshold);
+	exact.classify(image, binarize_threshold);
+	exact.classify(noisy, binarize_threshold);
+	if (exact.hits != 1 || exact.misses != 2)
+	{
+		printf("  tolerance 0: %zu hits and %zu misses, expected 1 and 2\n", exact.hits, exact.misses);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that a DebugRenderer whose viewer throws counts the snapshot as dropped, and keeps rendering later snapshots.
+ */
+static bool check_debug_renderer(const Image &, const uint32_t)
+{
+	size_t shown = 0;
+	DebugRenderer renderer([&](const std::string &name, const cv::Mat &)
+						   {
+		if (name == "throwing")
+			throw std::runtime_error("viewer failed");
+		shown++; });
+
+	const std::vector<std::vector<double>> hough_transform(4, std::vector<double>(3, 1.0));
+	renderer.submit_hough_transform("throwing", hough_transform);
+	renderer.submit_hough_transform("shown", hough_transform);
+	renderer.wait_until_idle();
+	if (renderer.dropped() != 1 || shown != 1)
+	{
+		printf("  %zu dropped and %zu shown, expected 1 of each\n", renderer.dropped(), shown);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Checks that the sparse and dense accumulators of Hough::find_lines() give the same lines and vote histogram, at the default
+ * and a finer angular resolution, and that both histograms match that of the hough transform.
+ */
+static bool check_sparse_hough(const Image &image, const uint32_t binarize_threshold)
+{
+	const BinaryImage binary_image(image, binarize_threshold);
+	Hough transform;
+	transform.create_hough_transform(binary_image);
+
+	for (const Degrees angular_resolution : {1.0, 0.5})
+	{
+		Hough dense(angular_resolution), sparse(angular_resolution);
+		dense.set_accumulator_backend(AccumulatorBackend::DENSE);
+		sparse.set_accumulator_backend(AccumulatorBackend::SPARSE);
+		const std::vector<Line> dense_lines = dense.find_lines(image, binary_image);
+		const std::vector<Line> sparse_lines = sparse.find_lines(image, binary_image);
+
+		bool identical = dense_lines.size() == sparse_lines.size() && dense.get_vote_histogram() == sparse.get_vote_histogram();
+		for (size_t i = 0; identical && i < dense_lines.size(); i++)
+			identical = dense_lines[i].polar.r == sparse_lines[i].polar.r && dense_lines[i].polar.theta == sparse_lines[i].polar.theta;
+		if (!identical || (angular_resolution == 1.0 && dense.get_vote_histogram() != transform.get_vote_histogram()))
+		{
+			printf("  %g degrees: sparse and dense lines or vote histograms differ\n", angular_resolution);
+			return false;
+		}
+	}
+	return true;
+}
+
+static constexpr SelfCheck checks[] = {
+	{"binary-log", check_binary_log},
+	{"binary-image", check_binary_image},
+	{"court-tracker", check_court_tracker},
+	{"hough-batch", check_hough_batch},
+	{"sparse-hough", check_sparse_hough},
+	{"streaming-hough", check_streaming_hough},
+	{"debug-renderer", check_debug_renderer},
+	{"rle-decode", check_rle_decode},
+	{"result-slot", check_result_slot},
+	{"frame-gate", check_frame_gate},
+};
+
+/**
+ * @brief Runs the self checks against a frame, printing the result of each.
+ * @param[in] image - 8-bit frame to check against.
+ * @param[in] binarize_threshold - Samples greater than the threshold are valid.
+ * @param[in] name - Optional argument, name of the only check to run, otherwise every check is run.
+ * @return Exit code, 0 if every check passed, 1 if a check failed or the name is unknown.
+ */
+int run_self_checks(const Image &image, const uint32_t binarize_threshold, const std::string_view name)
+{
+	size_t run = 0, failed = 0;
+	for (const SelfCheck &check : checks)
+	{
+		if (!name.empty() && name != check.name)
+			continue;
+
+		const bool passed = check.run(image, binarize_threshold);
+		printf("%-24.*s %s\n", static_cast<int>(check.name.size()), check.name.data(), passed ? "pass" : "FAIL");
+		run++;
+		failed += passed ? 0 : 1;
+	}
+
+	if (run == 0)
+	{
+		std::cerr << "Unknown check " << name << ", expected one of:";
+		for (const SelfCheck &check : checks)
+			std::cerr << " " << check.name;
+		std::cerr << "\n";
+		return 1;
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include <sparse-accumulator.h>
+#include <algorithm>
+#include <bit>
+
+/**
+ * @brief Constructs an empty accumulator.
+ * @param[in] expected_cells - Optional argument, number of cells expected to receive votes, used to size the table.
+ */
+SparseAccumulator::SparseAccumulator(const size_t expected_cells)
+	: slots(capacity_for(expected_cells))
+{
+}
+
+/**
+ * @brief Calculates the memory of an accumulator sized for a number of voted cells, to compare against a dense accumulator.
+ * @param[in] expected_cells - Number of cells expected to receive votes.
+ * @return Size of the table, in bytes.
+ */
+size_t SparseAccumulator::memory_usage(const size_t expected_cells)
+{
+	return capacity_for(expected_cells) * sizeof(Slot);
+}
+
+/**
+ * @brief Adds a vote to a cell.
+ * @param[in] theta_index - Angle index of the cell, at most MAX_INDEX.
+ * @param[in] r - Radius bin of the cell, at most MAX_INDEX.
+ * @return Votes of the cell prior to this vote.
+ */
+uint32_t SparseAccumulator::increment(const uint32_t theta_index, const uint32_t r)
+{
+	const uint32_t key = make_key(theta_index, r);
+	size_t slot = find_slot(key);
+	if (slots[slot].key == EMPTY_KEY)
+	{
+		if ((count + 1) * 4 > slots.size() * 3)
+		{
+			grow();
+			slot = find_slot(key);
+		}
+		slots[slot].key = key;
+		count++;
+	}
+	return slots[slot].votes++;
+}
+
+/**
+ * @brief Gets the votes of a cell.
+ * @param[in] theta_index - Angle index of the cell.
+ * @param[in] r - Radius bin of the cell.
+ * @return Votes of the cell, 0 if it has not been voted for.
+ */
+uint32_t SparseAccumulator::get(const uint32_t theta_index, const uint32_t r) const
+{
+	return slots[find_slot(make_key(theta_index, r))].votes;
+}
+
+/**
+ * @brief Finds all cells with more votes than the threshold.
+ * @param[in] threshold - Votes a cell must exceed.
+ * @return Cells above the threshold, in no particular order.
+ */
+std::vector<SparseAccumulator::Cell> SparseAccumulator::cells_above(const uint32_t threshold) const
+{
+	std::vector<Cell> cells;
+	for (const Slot &slot : slots)
+		if (slot.key != EMPTY_KEY && slot.votes > threshold)
+			cells.push_back({slot.key >> 16, slot.key & 0xFFFF, slot.votes});
+	return cells;
+}
+
+/**
+ * @brief Finds the slot of a key, or the empty slot where it would be inserted.
+ * @param[in] key - Key of the cell.
+ * @return Index of the slot.
+ */
+size_t SparseAccumulator::find_slot(const uint32_t key) const
+{
+	// Fibonacci hashing spreads neighbouring radii, which are voted for consecutively, across the table.
+	const size_t mask = slots.size() - 1;
+	size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - std::countr_zero(slots.size()))) & mask;
+	while (slots[slot].key != key && slots[slot].key != EMPTY_KEY)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+/**
+ * @brief Doubles the capacity of the table, re-inserting all cells.
+ */
+void SparseAccumulator::grow()
+{
+	std::vector<Slot> old_slots(slots.size() * 2);
+	old_slots.swap(slots);
+	for (const Slot &slot : old_slots)
+		if (slot.key != EMPTY_KEY)
+			slots[find_slot(slot.key)] = slot;
+}
@@ -0,0 +1,72 @@
+#include <stratified-hough.h>
+#include <algorithm>
+#include <array>
+
+/**
+ * @brief Votes every sample of an image once, into the bucket of its intensity.
+ * @param[in] image - 8-bit image, before binarisation.
+ * @param[in] thresholds - Candidate binarisation thresholds, samples greater than a threshold are valid for it.
+ */
+StratifiedHough::StratifiedHough(const Image &image, std::vector<uint32_t> thresholds)
+	: thresholds(std::move(thresholds))
+{
+	std::sort(this->thresholds.begin(), this->thresholds.end());
+	this->thresholds.erase(std::unique(this->thresholds.begin(), this->thresholds.end()), this->thresholds.end());
+
+	const size_t bucket_count = this->thresholds.size();
+	accumulators.assign(bucket_count, Hough::Accumulator(image.width, image.height));
+	if (bucket_count == 0)
+		return;
+
+	// Bucket of each intensity, i.e. the highest threshold it is above, or -1 if below all thresholds.
+	std::array<int32_t, 256> bucket_of;
+	for (uint32_t intensity = 0; intensity < bucket_of.size(); intensity++)
+		bucket_of[intensity] = static_cast<int32_t>(std::lower_bound(this->thresholds.begin(), this->thresholds.end(), intensity) - this->thresholds.begin()) - 1;
+
+	std::vector<std::vector<Coordinate::Cartesian>> coordinates(bucket_count);
+	for (size_t i = 0; i < image.samples.size(); i++)
+	{
+		const int32_t bucket = bucket_of[image.samples[i]];
+		if (bucket >= 0)
+			coordinates[bucket].push_back(image.index_to_coordinate(static_cast<int32_t>(i)));
+	}
+
+	const std::array<std::pair<double, double>, 270> &trig = Hough::trig_table();
+	const size_t tile = Hough::auto_angle_tile(accumulators.front().radii);
+	for (size_t k = 0; k < bucket_count; k++)
+		for (size_t angle_begin = 0; angle_begin < trig.size(); angle_begin += tile)
+			Hough::vote_angles(coordinates[k], trig.data(), angle_begin, std::min(angle_begin + tile, trig.size()), accumulators[k]);
+
+	// Suffix sums, so bucket k holds the votes of every sample above threshold k. The vote histograms are those of each bucket
+	// alone, so are not kept in step.
+	for (size_t k = bucket_count - 1; k-- > 0;)
+	{
+		const std::vector<uint32_t> &above = accumulators[k + 1].votes;
+		std::vector<uint32_t> &bucket = accumulators[k].votes;
+		for (size_t i = 0; i < bucket.size(); i++)
+			bucket[i] += above[i];
+		accumulators[k].max_r = std::max(accumulators[k].max_r, accumulators[k + 1].max_r);
+	}
+}
+
+/**
+ * @brief Creates the hough transform of the image binarised at one of the candidate thresholds.
+ * @param[in] threshold_index - Index into StratifiedHough::get_thresholds().
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> StratifiedHough::create_hough_transform(const size_t threshold_index) const
+{
+	return accumulators[threshold_index].to_hough_transform();
+}
+
+/**
+ * @brief Memory held by the accumulators of all buckets.
+ * @return Size in bytes.
+ */
+size_t StratifiedHough::memory_usage() const
+{
+	size_t bytes = 0;
+	for (const Hough::Accumulator &accumulator : accumulators)
+		bytes += accumulator.votes.size() * sizeof(uint32_t);
+	return bytes;
+}
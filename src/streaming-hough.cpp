@@ -0,0 +1,102 @@
+#include <streaming-hough.h>
+#include <algorithm>
+#include <cstdio>
+#include <future>
+#include <string>
+
+/**
+ * @brief Constructs an empty streaming transform.
+ * @param[in] width - Width of the frame.
+ * @param[in] height - Height of the frame.
+ * @param[in] binarize_threshold - Samples greater than the threshold are valid.
+ */
+StreamingHough::StreamingHough(const uint32_t width, const uint32_t height, const uint32_t binarize_threshold)
+	: width(width), height(height), binarize_threshold(binarize_threshold), binary_image(width, height), accumulator(width, height)
+{
+}
+
+/**
+ * @brief Binarises and votes the next stripe of rows.
+ * @param[in] samples - Samples of the stripe, row_count rows of width samples.
+ * @param[in] row_count - Number of rows in the stripe, rows beyond the frame's height are ignored.
+ */
+void StreamingHough::push_rows(const uint8_t *samples, const uint32_t row_count)
+{
+	const uint32_t rows = std::min(row_count, height - rows_received);
+
+	// Coordinates follow Image::index_to_coordinate(), x being the row and y the column.
+	stripe_coordinates.clear();
+	for (uint32_t row = 0; row < rows; row++)
+	{
+		const uint8_t *row_samples = samples + static_cast<size_t>(row) * width;
+		const size_t row_index = (static_cast<size_t>(rows_received) + row) * width;
+		for (uint32_t col = 0; col < width; col++)
+		{
+			if (row_samples[col] > binarize_threshold)
+			{
+				binary_image.set(row_index + col);
+				stripe_coordinates.push_back({static_cast<int64_t>(rows_received + row), static_cast<int64_t>(col)});
+			}
+		}
+	}
+	rows_received += rows;
+
+	const std::array<std::pair<double, double>, 270> &trig = Hough::trig_table();
+	const size_t tile = Hough::auto_angle_tile(accumulator.radii);
+	for (size_t angle_begin = 0; angle_begin < trig.size(); angle_begin += tile)
+		Hough::vote_angles(stripe_coordinates, trig.data(), angle_begin, std::min(angle_begin + tile, trig.size()), accumulator);
+
+	if (is_complete())
+		accumulator.complete_histogram();
+}
+
+/**
+ * @brief Converts the accumulator to a hough transform, for use with Hough::get_hough_lines().
+ * @note May be called before the frame is complete, to inspect the votes so far.
+ * @return Hough transform represented as 2D Vector.
+ */
+std::vector<std::vector<double>> StreamingHough::finish() const
+{
+	return accumulator.to_hough_transform();
+}
+
+/**
+ * @brief Streams a .raw file into a streaming transform, one stripe at a time.
+ * @details The next stripe is read on another thread whilst the current stripe is voted, overlapping I/O with compute. Only 2
+ * stripes of 8-bit samples are held in memory, so frames whose samples would not fit in memory can be transformed.
+ * @param[in] path - Path to .raw file.
+ * @param[in,out] hough - Streaming transform, which defines the frame size.
+ * @param[in] stripe_rows - Optional argument, number of rows per stripe.
+ * @return Flag indicating if the whole frame was read.
+ */
+bool stream_raw_file(const std::string_view path, StreamingHough &hough, const uint32_t stripe_rows)
+{
+	FILE *fp = fopen(std::string(path).c_str(), "rb");
+	if (!fp)
+		return false;
+
+	std::vector<uint8_t> stripes[2] = {std::vector<uint8_t>(static_cast<size_t>(stripe_rows) * hough.width),
+									   std::vector<uint8_t>(static_cast<size_t>(stripe_rows) * hough.width)};
+	uint32_t rows_read = 0;
+	const auto read_stripe = [&](std::vector<uint8_t> &stripe) -> uint32_t
+	{
+		const uint32_t rows = std::min(stripe_rows, hough.height - rows_read);
+		if (rows == 0 || fread(stripe.data(), static_cast<size_t>(rows) * hough.width, 1, fp) != 1)
+			return 0;
+		rows_read += rows;
+		return rows;
+	};
+
+	std::future<uint32_t> pending = std::async(std::launch::async, read_stripe, std::ref(stripes[0]));
+	for (size_t current = 0;; current ^= 1)
+	{
+		const uint32_t rows = pending.get();
+		if (rows == 0)
+			break;
+		pending = std::async(std::launch::async, read_stripe, std::ref(stripes[current ^ 1]));
+		hough.push_rows(stripes[current].data(), rows);
+	}
+
+	fclose(fp);
+	return hough.is_complete();
+}